@@ -53,20 +53,10 @@
  #endif
 
 
-/* If defined, global variables will be used, otherwise CANopen objects will
-   be generated with calloc(). */
-/* #define CO_USE_GLOBALS */
-
 /* If defined, the user provides an own implemetation for calculating the
  * CRC16 CCITT checksum. */
 /* #define CO_USE_OWN_CRC16 */
 
-#ifndef CO_USE_GLOBALS
-    #include <stdlib.h> /*  for malloc, free */
-    static uint32_t CO_memoryUsed = 0; /* informative */
-#endif
-
-
 /* Global variables ***********************************************************/
     extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];  /* Object Dictionary array */
     static CO_t COO;
@@ -75,15 +65,19 @@
     static CO_CANrx_t          *CO_CANmodule_rxArray0;
     static CO_CANtx_t          *CO_CANmodule_txArray0;
     static CO_OD_extension_t   *CO_SDO_ODExtensions;
+    static CO_OD_entryInfo_t   *CO_SDO_ODInfo;
+    static uint16_t            *CO_SDO_ODPages;
+    static CO_OD_descriptor_t  *CO_SDO_ODDescriptors;
+    static uint32_t            *CO_SDO_ODDirty;
+    static uint32_t            *CO_SDO_ODTPDOMap;
+    static CO_TPDO_t          **CO_TPDOqueue;
     static CO_HBconsNode_t     *CO_HBcons_monitoredNodes;
 #if CO_NO_TRACE > 0
     static uint32_t            *CO_traceTimeBuffers[CO_NO_TRACE];
     static int32_t             *CO_traceValueBuffers[CO_NO_TRACE];
-  #ifdef CO_USE_GLOBALS
   #ifndef CO_TRACE_BUFFER_SIZE_FIXED
     #define CO_TRACE_BUFFER_SIZE_FIXED 100
   #endif
-  #endif
 #endif
 
 
@@ -129,28 +123,97 @@
     #define CO_TXCAN_NO_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
 
 
-#ifdef CO_USE_GLOBALS
-    static CO_CANmodule_t       COO_CANmodule;
-    static CO_CANrx_t           COO_CANmodule_rxArray0[CO_RXCAN_NO_MSGS];
-    static CO_CANtx_t           COO_CANmodule_txArray0[CO_TXCAN_NO_MSGS];
-    static CO_SDO_t             COO_SDO[CO_NO_SDO_SERVER];
-    static CO_OD_extension_t    COO_SDO_ODExtensions[CO_OD_NoOfElements];
-    static CO_EM_t              COO_EM;
-    static CO_EMpr_t            COO_EMpr;
-    static CO_NMT_t             COO_NMT;
-    static CO_SYNC_t            COO_SYNC;
-    static CO_RPDO_t            COO_RPDO[CO_NO_RPDO];
-    static CO_TPDO_t            COO_TPDO[CO_NO_TPDO];
-    static CO_HBconsumer_t      COO_HBcons;
-    static CO_HBconsNode_t      COO_HBcons_monitoredNodes[CO_NO_HB_CONS];
+/* Size of hash table of OD extensions ****************************************/
+    /* OD entries configured by application, for example by CO_eeprom */
+    #ifndef CO_OD_NO_OF_APP_EXTENSIONS
+        #define CO_OD_NO_OF_APP_EXTENSIONS  4
+    #endif
+
+    /* SYNC: 1005, 1006, 1019; Emergency: 1003, 1014; Heartbeat consumer: 1016;
+     * SDO: 1200+; PDO: communication and mapping parameter; trace: 2 entries */
+    #define CO_OD_NO_OF_EXTENSIONS (3+2+1+CO_NO_SDO_SERVER+2*CO_NO_RPDO+2*CO_NO_TPDO+2*CO_NO_TRACE+CO_OD_NO_OF_APP_EXTENSIONS)
+    /* keep hash table at most two thirds full */
+    #define CO_OD_EXTENSIONS_SIZE  (CO_OD_NO_OF_EXTENSIONS+CO_OD_NO_OF_EXTENSIONS/2)
+
+
+/* Deadbands for Change of State detection of TPDO mapped analog values *****/
+    /* CiA 401: analog input interrupt delta for analog inputs */
+#ifdef OD_analogueInputInterruptDeltaUnsigned
+    static const CO_TPDOdeadband_t CO_TPDOdeadbands[] = {
+        {0x6401, true, ODL_analogueInputInterruptDeltaUnsigned_arrayLength, &OD_analogueInputInterruptDeltaUnsigned[0]}
+    };
+    #define CO_TPDO_DEADBANDS       CO_TPDOdeadbands
+    #define CO_NO_TPDO_DEADBANDS    (sizeof(CO_TPDOdeadbands)/sizeof(CO_TPDOdeadbands[0]))
+#else
+    #define CO_TPDO_DEADBANDS       NULL
+    #define CO_NO_TPDO_DEADBANDS    0
+#endif
+
+
+/* Object scanner and dispatcher lists of multiplexed PDOs ******************/
+#if CO_CONFIG_MPDO
+    /* SAM MPDO producer cycles through all analog inputs */
+  #ifdef OD_readAnalogueInput16Bit
+    static CO_MPDOscannerEntry_t CO_MPDOscanner[] = {
+        {.object = CO_MPDO_SCANNER_ENTRY(0x6401, 1, ODL_readAnalogueInput16Bit_arrayLength)}
+    };
+    #define CO_MPDO_SCANNER         CO_MPDOscanner
+    #define CO_NO_MPDO_SCANNER      (sizeof(CO_MPDOscanner)/sizeof(CO_MPDOscanner[0]))
+  #else
+    #define CO_MPDO_SCANNER         NULL
+    #define CO_NO_MPDO_SCANNER      0
+  #endif
+    /* SAM MPDO consumer, dispatcher list may be defined by application */
+  #ifndef CO_MPDO_DISPATCHER
+    #define CO_MPDO_DISPATCHER      NULL
+    #define CO_NO_MPDO_DISPATCHER   0
+  #endif
+#endif
+
+
+/* Arena with all CANopen objects *********************************************/
+    /* Objects used by the real time context (CAN module, SYNC, PDOs and data
+     * they touch in the Object Dictionary extension) are first, so they are
+     * contiguous in memory. Size of the arena is known at compile time. */
+    typedef struct{
+        CO_CANmodule_t      CANmodule;
+        CO_CANrx_t          CANmodule_rxArray0[CO_RXCAN_NO_MSGS];
+        CO_CANtx_t          CANmodule_txArray0[CO_TXCAN_NO_MSGS];
+        CO_SYNC_t           SYNC;
+        CO_RPDO_t           RPDO[CO_NO_RPDO];
+        CO_TPDO_t           TPDO[CO_NO_TPDO];
+        CO_TPDOtimers_t     TPDOtimers;
+        CO_TPDO_t          *TPDOqueue[CO_NO_TPDO];
+        CO_PDOlists_t       PDOlists;
+        CO_OD_entryInfo_t   SDO_ODInfo[CO_OD_NoOfElements];
+        CO_OD_descriptor_t  SDO_ODDescriptors[CO_OD_NoOfSubIndexes];
+        uint32_t            SDO_ODDirty[CO_OD_DIRTY_SIZE(CO_OD_NoOfElements)];
+        uint32_t            SDO_ODTPDOMap[CO_OD_NoOfElements];
+        uint16_t            SDO_ODPages[CO_OD_PAGE_TABLE_SIZE];
+        CO_OD_extension_t   SDO_ODExtensions[CO_OD_EXTENSIONS_SIZE];
+        CO_SDO_t            SDO[CO_NO_SDO_SERVER];
+        CO_EM_t             EM;
+        CO_EMpr_t           EMpr;
+        CO_NMT_t            NMT;
+        CO_HBconsumer_t     HBcons;
+        CO_HBconsNode_t     HBcons_monitoredNodes[CO_NO_HB_CONS];
 #if CO_NO_SDO_CLIENT == 1
-    static CO_SDOclient_t       COO_SDOclient;
+        CO_SDOclient_t      SDOclient;
 #endif
 #if CO_NO_TRACE > 0
-    static CO_trace_t           COO_trace[CO_NO_TRACE];
-    static uint32_t             COO_traceTimeBuffers[CO_NO_TRACE][CO_TRACE_BUFFER_SIZE_FIXED];
-    static int32_t              COO_traceValueBuffers[CO_NO_TRACE][CO_TRACE_BUFFER_SIZE_FIXED];
+        CO_trace_t          trace[CO_NO_TRACE];
+        uint32_t            traceTimeBuffers[CO_NO_TRACE][CO_TRACE_BUFFER_SIZE_FIXED];
+        int32_t             traceValueBuffers[CO_NO_TRACE][CO_TRACE_BUFFER_SIZE_FIXED];
 #endif
+    }CO_arena_t;
+
+    static CO_arena_t COO_arena CO_ARENA_SECTION;
+
+    const uint32_t CO_memoryUsed = sizeof(CO_arena_t);
+
+    /* optional RAM budget, verified at compile time */
+#ifdef CO_ARENA_MAX_SIZE
+    typedef char CO_arenaSizeCheck_t[(sizeof(CO_arena_t) <= (CO_ARENA_MAX_SIZE)) ? 1 : -1];
 #endif
 
 
@@ -194,186 +257,15 @@
 #endif
 
 
-/******************************************************************************/
-CO_ReturnError_t CO_init(
-        struct can_async_descriptor   *CANbaseAddress,
-        uint8_t                 nodeId,
-        uint16_t                bitRate)
-{
-
+/*
+ * Initialize all CANopen objects from communication parameters in Object
+ * Dictionary and bind them to CAN buffers. CAN module must be initialized.
+ * If keepOD is true, Object Dictionary tables and extensions from previous
+ * initialization are reused.
+ */
+static CO_ReturnError_t CO_initObjects(uint8_t nodeId, bool_t keepOD){
     int16_t i;
     CO_ReturnError_t err;
-#ifndef CO_USE_GLOBALS
-    uint16_t errCnt;
-#endif
-#if CO_NO_TRACE > 0
-    uint32_t CO_traceBufferSize[CO_NO_TRACE];
-#endif
-
-    /* Verify parameters from CO_OD */
-    if(   sizeof(OD_TPDOCommunicationParameter_t) != sizeof(CO_TPDOCommPar_t)
-       || sizeof(OD_TPDOMappingParameter_t) != sizeof(CO_TPDOMapPar_t)
-       || sizeof(OD_RPDOCommunicationParameter_t) != sizeof(CO_RPDOCommPar_t)
-       || sizeof(OD_RPDOMappingParameter_t) != sizeof(CO_RPDOMapPar_t))
-    {
-        return CO_ERROR_PARAMETERS;
-    }
-
-    #if CO_NO_SDO_CLIENT == 1
-	//	if(sizeof(OD_SDOClientParameter_t) != sizeof(CO_SDOclientPar_t)){
-	//		return CO_ERROR_PARAMETERS;
-	//	}
-    #endif
-
-
-    /* Initialize CANopen object */
-#ifdef CO_USE_GLOBALS
-    CO = &COO;
-
-    CO->CANmodule[0]                    = &COO_CANmodule;
-    CO_CANmodule_rxArray0               = &COO_CANmodule_rxArray0[0];
-    CO_CANmodule_txArray0               = &COO_CANmodule_txArray0[0];
-    for(i=0; i<CO_NO_SDO_SERVER; i++)
-        CO->SDO[i]                      = &COO_SDO[i];
-    CO_SDO_ODExtensions                 = &COO_SDO_ODExtensions[0];
-    CO->em                              = &COO_EM;
-    CO->emPr                            = &COO_EMpr;
-    CO->NMT                             = &COO_NMT;
-    CO->SYNC                            = &COO_SYNC;
-    for(i=0; i<CO_NO_RPDO; i++)
-        CO->RPDO[i]                     = &COO_RPDO[i];
-    for(i=0; i<CO_NO_TPDO; i++)
-        CO->TPDO[i]                     = &COO_TPDO[i];
-    CO->HBcons                          = &COO_HBcons;
-    CO_HBcons_monitoredNodes            = &COO_HBcons_monitoredNodes[0];
-  #if CO_NO_SDO_CLIENT == 1
-    CO->SDOclient                       = &COO_SDOclient;
-  #endif
-  #if CO_NO_TRACE > 0
-    for(i=0; i<CO_NO_TRACE; i++) {
-        CO->trace[i]                    = &COO_trace[i];
-        CO_traceTimeBuffers[i]          = &COO_traceTimeBuffers[i][0];
-        CO_traceValueBuffers[i]         = &COO_traceValueBuffers[i][0];
-        CO_traceBufferSize[i]           = CO_TRACE_BUFFER_SIZE_FIXED;
-    }
-  #endif
-#else
-    if(CO == NULL){    /* Use malloc only once */
-        CO = &COO;
-        CO->CANmodule[0]                    = (CO_CANmodule_t *)    calloc(1, sizeof(CO_CANmodule_t));
-        CO_CANmodule_rxArray0               = (CO_CANrx_t *)        calloc(CO_RXCAN_NO_MSGS, sizeof(CO_CANrx_t));
-        CO_CANmodule_txArray0               = (CO_CANtx_t *)        calloc(CO_TXCAN_NO_MSGS, sizeof(CO_CANtx_t));
-        for(i=0; i<CO_NO_SDO_SERVER; i++){
-            CO->SDO[i]                      = (CO_SDO_t *)          calloc(1, sizeof(CO_SDO_t));
-        }
-        CO_SDO_ODExtensions                 = (CO_OD_extension_t*)  calloc(CO_OD_NoOfElements, sizeof(CO_OD_extension_t));
-        CO->em                              = (CO_EM_t *)           calloc(1, sizeof(CO_EM_t));
-        CO->emPr                            = (CO_EMpr_t *)         calloc(1, sizeof(CO_EMpr_t));
-        CO->NMT                             = (CO_NMT_t *)          calloc(1, sizeof(CO_NMT_t));
-        CO->SYNC                            = (CO_SYNC_t *)         calloc(1, sizeof(CO_SYNC_t));
-        for(i=0; i<CO_NO_RPDO; i++){
-            CO->RPDO[i]                     = (CO_RPDO_t *)         calloc(1, sizeof(CO_RPDO_t));
-        }
-        for(i=0; i<CO_NO_TPDO; i++){
-            CO->TPDO[i]                     = (CO_TPDO_t *)         calloc(1, sizeof(CO_TPDO_t));
-        }
-        CO->HBcons                          = (CO_HBconsumer_t *)   calloc(1, sizeof(CO_HBconsumer_t));
-        CO_HBcons_monitoredNodes            = (CO_HBconsNode_t *)   calloc(CO_NO_HB_CONS, sizeof(CO_HBconsNode_t));
-      #if CO_NO_SDO_CLIENT == 1
-        CO->SDOclient                       = (CO_SDOclient_t *)    calloc(1, sizeof(CO_SDOclient_t));
-      #endif
-      #if CO_NO_TRACE > 0
-        for(i=0; i<CO_NO_TRACE; i++) {
-            CO->trace[i]                    = (CO_trace_t *)        calloc(1, sizeof(CO_trace_t));
-            CO_traceTimeBuffers[i]          = (uint32_t *)          calloc(OD_traceConfig[i].size, sizeof(uint32_t));
-            CO_traceValueBuffers[i]         = (int32_t *)           calloc(OD_traceConfig[i].size, sizeof(int32_t));
-            if(CO_traceTimeBuffers[i] != NULL && CO_traceValueBuffers[i] != NULL) {
-                CO_traceBufferSize[i] = OD_traceConfig[i].size;
-            } else {
-                CO_traceBufferSize[i] = 0;
-            }
-        }
-      #endif
-    }
-
-    CO_memoryUsed = sizeof(CO_CANmodule_t)
-                  + sizeof(CO_CANrx_t) * CO_RXCAN_NO_MSGS
-                  + sizeof(CO_CANtx_t) * CO_TXCAN_NO_MSGS
-                  + sizeof(CO_SDO_t) * CO_NO_SDO_SERVER
-                  + sizeof(CO_OD_extension_t) * CO_OD_NoOfElements
-                  + sizeof(CO_EM_t)
-                  + sizeof(CO_EMpr_t)
-                  + sizeof(CO_NMT_t)
-                  + sizeof(CO_SYNC_t)
-                  + sizeof(CO_RPDO_t) * CO_NO_RPDO
-                  + sizeof(CO_TPDO_t) * CO_NO_TPDO
-                  + sizeof(CO_HBconsumer_t)
-                  + sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS
-  #if CO_NO_SDO_CLIENT == 1
-                  + sizeof(CO_SDOclient_t)
-  #endif
-                  + 0;
-  #if CO_NO_TRACE > 0
-    CO_memoryUsed += sizeof(CO_trace_t) * CO_NO_TRACE;
-    for(i=0; i<CO_NO_TRACE; i++) {
-        CO_memoryUsed += CO_traceBufferSize[i] * 8;
-    }
-  #endif
-
-    errCnt = 0;
-    if(CO->CANmodule[0]                 == NULL) errCnt++;
-    if(CO_CANmodule_rxArray0            == NULL) errCnt++;
-    if(CO_CANmodule_txArray0            == NULL) errCnt++;
-    for(i=0; i<CO_NO_SDO_SERVER; i++){
-        if(CO->SDO[i]                   == NULL) errCnt++;
-    }
-    if(CO_SDO_ODExtensions              == NULL) errCnt++;
-    if(CO->em                           == NULL) errCnt++;
-    if(CO->emPr                         == NULL) errCnt++;
-    if(CO->NMT                          == NULL) errCnt++;
-    if(CO->SYNC                         == NULL) errCnt++;
-    for(i=0; i<CO_NO_RPDO; i++){
-        if(CO->RPDO[i]                  == NULL) errCnt++;
-    }
-    for(i=0; i<CO_NO_TPDO; i++){
-        if(CO->TPDO[i]                  == NULL) errCnt++;
-    }
-    if(CO->HBcons                       == NULL) errCnt++;
-    if(CO_HBcons_monitoredNodes         == NULL) errCnt++;
-  #if CO_NO_SDO_CLIENT == 1
-    if(CO->SDOclient                    == NULL) errCnt++;
-  #endif
-  #if CO_NO_TRACE > 0
-    for(i=0; i<CO_NO_TRACE; i++) {
-        if(CO->trace[i]                 == NULL) errCnt++;
-    }
-  #endif
-
-    if(errCnt != 0) return CO_ERROR_OUT_OF_MEMORY;
-#endif
-
-
-    CO->CANmodule[0]->CANnormal = false;
-    CO_CANsetConfigurationMode(CANbaseAddress);
-
-    /* Verify CANopen Node-ID */
-    if(nodeId<1 || nodeId>127)
-    {
-        CO_delete(CAN1);
-        return CO_ERROR_PARAMETERS;
-    }
-
-
-    err = CO_CANmodule_init(
-            CO->CANmodule[0],
-            &CAN_0,
-            CO_CANmodule_rxArray0,
-            CO_RXCAN_NO_MSGS,
-            CO_CANmodule_txArray0,
-            CO_TXCAN_NO_MSGS,
-            bitRate);
-
-    if(err){CO_delete(CANbaseAddress); return err;}
 
     for (i=0; i<CO_NO_SDO_SERVER; i++)
     {
@@ -394,9 +286,16 @@ CO_ReturnError_t CO_init(
                 COB_IDServerToClient,
                 OD_H1200_SDO_SERVER_PARAM+i,
                 i==0 ? 0 : CO->SDO[0],
-               &CO_OD[0],
+                keepOD ? NULL : &CO_OD[0],
                 CO_OD_NoOfElements,
                 CO_SDO_ODExtensions,
+                CO_OD_EXTENSIONS_SIZE,
+                CO_SDO_ODInfo,
+                NULL,   /* page table and descriptors are built by CO_initDeferred() */
+                NULL,
+                0,
+                CO_SDO_ODDirty,
+                CO_SDO_ODTPDOMap,
                 nodeId,
                 CO->CANmodule[0],
                 CO_RXCAN_SDO_SRV+i,
@@ -404,7 +303,7 @@ CO_ReturnError_t CO_init(
                 CO_TXCAN_SDO_SRV+i);
     }
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
 
 
     err = CO_EM_init(
@@ -420,7 +319,7 @@ CO_ReturnError_t CO_init(
             CO_TXCAN_EMERG,
             CO_CAN_ID_EMERGENCY + nodeId);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
 
 
     err = CO_NMT_init(
@@ -435,7 +334,7 @@ CO_ReturnError_t CO_init(
             CO_TXCAN_HB,
             CO_CAN_ID_HEARTBEAT + nodeId);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
 
 
 #if CO_NO_NMT_MASTER == 1
@@ -462,8 +361,10 @@ CO_ReturnError_t CO_init(
             CO->CANmodule[0],
             CO_TXCAN_SYNC);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
+
 
+    CO_PDOlists_init(CO->PDOlists);
 
     for(i=0; i<CO_NO_RPDO; i++){
         CO_CANmodule_t *CANdevRx = CO->CANmodule[0];
@@ -474,6 +375,7 @@ CO_ReturnError_t CO_init(
                 CO->em,
                 CO->SDO[0],
                 CO->SYNC,
+                CO->PDOlists,
                &CO->NMT->operatingState,
                 nodeId,
                 ((i<4) ? (CO_CAN_ID_RPDO_1+i*0x100) : 0),
@@ -485,15 +387,30 @@ CO_ReturnError_t CO_init(
                 CANdevRx,
                 CANdevRxIdx);
 
-        if(err){CO_delete(CANbaseAddress); return err;}
+        if(err) return err;
+
+#if CO_CONFIG_MPDO
+        err = CO_RPDO_initMPDO(CO->RPDO[i], CO_MPDO_DISPATCHER, CO_NO_MPDO_DISPATCHER);
+
+        if(err) return err;
+#endif
     }
 
 
+    CO_TPDOtimers_init(
+            CO->TPDOtimers,
+            CO->TPDO,
+            CO_TPDOqueue,
+            CO_NO_TPDO,
+           &CO->NMT->operatingState);
+
     for(i=0; i<CO_NO_TPDO; i++){
         err = CO_TPDO_init(
                 CO->TPDO[i],
                 CO->em,
                 CO->SDO[0],
+                CO->TPDOtimers,
+                CO->PDOlists,
                &CO->NMT->operatingState,
                 nodeId,
                 ((i<4) ? (CO_CAN_ID_TPDO_1+i*0x100) : 0),
@@ -502,10 +419,18 @@ CO_ReturnError_t CO_init(
                 (CO_TPDOMapPar_t*) &OD_TPDOMappingParameter[i],
                 OD_H1800_TXPDO_1_PARAM+i,
                 OD_H1A00_TXPDO_1_MAPPING+i,
+                CO_TPDO_DEADBANDS,
+                CO_NO_TPDO_DEADBANDS,
                 CO->CANmodule[0],
                 CO_TXCAN_TPDO+i);
 
-        if(err){CO_delete(CANbaseAddress); return err;}
+        if(err) return err;
+
+#if CO_CONFIG_MPDO
+        err = CO_TPDO_initMPDO(CO->TPDO[i], CO_MPDO_SCANNER, CO_NO_MPDO_SCANNER, 0);
+
+        if(err) return err;
+#endif
     }
 
 
@@ -519,7 +444,7 @@ CO_ReturnError_t CO_init(
             CO->CANmodule[0],
             CO_RXCAN_CONS_HB);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
 
 
 #if CO_NO_SDO_CLIENT == 1
@@ -532,7 +457,7 @@ CO_ReturnError_t CO_init(
             CO->CANmodule[0],
             CO_TXCAN_SDO_CLI);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+    if(err) return err;
 #endif
 
 
@@ -544,7 +469,7 @@ CO_ReturnError_t CO_init(
             OD_traceConfig[i].axisNo,
             CO_traceTimeBuffers[i],
             CO_traceValueBuffers[i],
-            CO_traceBufferSize[i],
+            CO_TRACE_BUFFER_SIZE_FIXED,
             &OD_traceConfig[i].map,
             &OD_traceConfig[i].format,
             &OD_traceConfig[i].trigger,
@@ -564,46 +489,138 @@ CO_ReturnError_t CO_init(
 
 
 /******************************************************************************/
-void CO_delete(struct can_async_descriptor *const  CANbaseAddress){
-#ifndef CO_USE_GLOBALS
+CO_ReturnError_t CO_init(
+        struct can_async_descriptor   *CANbaseAddress,
+        uint8_t                 nodeId,
+        uint16_t                bitRate)
+{
+
     int16_t i;
-#endif
+    CO_ReturnError_t err;
 
-    CO_CANsetConfigurationMode(CANbaseAddress);
-    CO_CANmodule_disable(CO->CANmodule[0]);
+    /* Verify parameters from CO_OD */
+    if(   sizeof(OD_TPDOCommunicationParameter_t) != sizeof(CO_TPDOCommPar_t)
+       || sizeof(OD_TPDOMappingParameter_t) != sizeof(CO_TPDOMapPar_t)
+       || sizeof(OD_RPDOCommunicationParameter_t) != sizeof(CO_RPDOCommPar_t)
+       || sizeof(OD_RPDOMappingParameter_t) != sizeof(CO_RPDOMapPar_t))
+    {
+        return CO_ERROR_PARAMETERS;
+    }
 
-#ifndef CO_USE_GLOBALS
-  #if CO_NO_TRACE > 0
-      for(i=0; i<CO_NO_TRACE; i++) {
-          free(CO->trace[i]);
-          free(CO_traceTimeBuffers[i]);
-          free(CO_traceValueBuffers[i]);
-      }
-  #endif
+    #if CO_NO_SDO_CLIENT == 1
+	//	if(sizeof(OD_SDOClientParameter_t) != sizeof(CO_SDOclientPar_t)){
+	//		return CO_ERROR_PARAMETERS;
+	//	}
+    #endif
+
+
+    /* Initialize CANopen object. All objects are in the arena, so nothing is
+     * allocated and repeated communication reset does not fragment memory. */
+    CO = &COO;
+
+    CO->CANmodule[0]                    = &COO_arena.CANmodule;
+    CO_CANmodule_rxArray0               = &COO_arena.CANmodule_rxArray0[0];
+    CO_CANmodule_txArray0               = &COO_arena.CANmodule_txArray0[0];
+    for(i=0; i<CO_NO_SDO_SERVER; i++)
+        CO->SDO[i]                      = &COO_arena.SDO[i];
+    CO_SDO_ODExtensions                 = &COO_arena.SDO_ODExtensions[0];
+    CO_SDO_ODInfo                       = &COO_arena.SDO_ODInfo[0];
+    CO_SDO_ODPages                      = &COO_arena.SDO_ODPages[0];
+    CO_SDO_ODDescriptors                = &COO_arena.SDO_ODDescriptors[0];
+    CO_SDO_ODDirty                      = &COO_arena.SDO_ODDirty[0];
+    CO_SDO_ODTPDOMap                    = &COO_arena.SDO_ODTPDOMap[0];
+    CO->em                              = &COO_arena.EM;
+    CO->emPr                            = &COO_arena.EMpr;
+    CO->NMT                             = &COO_arena.NMT;
+    CO->SYNC                            = &COO_arena.SYNC;
+    for(i=0; i<CO_NO_RPDO; i++)
+        CO->RPDO[i]                     = &COO_arena.RPDO[i];
+    for(i=0; i<CO_NO_TPDO; i++)
+        CO->TPDO[i]                     = &COO_arena.TPDO[i];
+    CO->TPDOtimers                      = &COO_arena.TPDOtimers;
+    CO_TPDOqueue                        = &COO_arena.TPDOqueue[0];
+    CO->PDOlists                        = &COO_arena.PDOlists;
+    CO->HBcons                          = &COO_arena.HBcons;
+    CO_HBcons_monitoredNodes            = &COO_arena.HBcons_monitoredNodes[0];
   #if CO_NO_SDO_CLIENT == 1
-    free(CO->SDOclient);
+    CO->SDOclient                       = &COO_arena.SDOclient;
   #endif
-    free(CO_HBcons_monitoredNodes);
-    free(CO->HBcons);
-    for(i=0; i<CO_NO_RPDO; i++){
-        free(CO->RPDO[i]);
+  #if CO_NO_TRACE > 0
+    for(i=0; i<CO_NO_TRACE; i++) {
+        CO->trace[i]                    = &COO_arena.trace[i];
+        CO_traceTimeBuffers[i]          = &COO_arena.traceTimeBuffers[i][0];
+        CO_traceValueBuffers[i]         = &COO_arena.traceValueBuffers[i][0];
     }
-    for(i=0; i<CO_NO_TPDO; i++){
-        free(CO->TPDO[i]);
+  #endif
+
+#ifdef OD_CANopenMemoryUsed
+    OD_CANopenMemoryUsed = CO_memoryUsed;
+#endif
+
+
+    CO->CANmodule[0]->CANnormal = false;
+    CO_CANsetConfigurationMode(CANbaseAddress);
+
+    /* Verify CANopen Node-ID */
+    if(nodeId<1 || nodeId>127)
+    {
+        CO_delete(CAN1);
+        return CO_ERROR_PARAMETERS;
     }
-    free(CO->SYNC);
-    free(CO->NMT);
-    free(CO->emPr);
-    free(CO->em);
-    free(CO_SDO_ODExtensions);
-    for(i=0; i<CO_NO_SDO_SERVER; i++){
-        free(CO->SDO[i]);
+
+
+    err = CO_CANmodule_init(
+            CO->CANmodule[0],
+            &CAN_0,
+            CO_CANmodule_rxArray0,
+            CO_RXCAN_NO_MSGS,
+            CO_CANmodule_txArray0,
+            CO_TXCAN_NO_MSGS,
+            bitRate);
+
+    if(err){CO_delete(CANbaseAddress); return err;}
+    CO_BOOT_TIME(CANModuleInit);
+
+    err = CO_initObjects(nodeId, false);
+
+    if(err){CO_delete(CANbaseAddress); return err;}
+    CO_BOOT_TIME(objectsInit);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_initDeferred(void){
+    CO_OD_buildTables(CO->SDO[0], CO_SDO_ODPages, CO_SDO_ODDescriptors, CO_OD_NoOfSubIndexes);
+    CO_BOOT_TIME(deferredInit);
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_resetCommunication(uint8_t nodeId){
+    CO_ReturnError_t err;
+
+    /* Verify CANopen Node-ID */
+    if(nodeId<1 || nodeId>127)
+    {
+        return CO_ERROR_PARAMETERS;
     }
-    free(CO_CANmodule_txArray0);
-    free(CO_CANmodule_rxArray0);
-    free(CO->CANmodule[0]);
-    CO = NULL;
-#endif
+
+    /* CAN controller and filters keep running, CAN buffers are rebound by
+     * CANopen objects. Object dictionary tables are kept. */
+    CO_CANmodule_reset(CO->CANmodule[0]);
+
+    err = CO_initObjects(nodeId, true);
+
+    return err;
+}
+
+
+/******************************************************************************/
+void CO_delete(struct can_async_descriptor *const  CANbaseAddress){
+    CO_CANsetConfigurationMode(CANbaseAddress);
+    CO_CANmodule_disable(CO->CANmodule[0]);
 }
 
 
@@ -611,42 +628,70 @@ void CO_delete(struct can_async_descriptor *const  CANbaseAddress){
 CO_NMT_reset_cmd_t CO_process(
         CO_t                   *CO,
         uint16_t                timeDifference_ms,
-        uint16_t               *timerNext_ms)
+        uint16_t               *timerNext_ms,
+        bool_t                 *PDOchanged)
 {
     uint8_t i;
     bool_t NMTisPreOrOperational = false;
     CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
     static uint16_t ms50 = 0;
+    static uint8_t NMTstatePrev = CO_NMT_INITIALIZING;
 
     if(CO->NMT->operatingState == CO_NMT_PRE_OPERATIONAL || CO->NMT->operatingState == CO_NMT_OPERATIONAL)
         NMTisPreOrOperational = true;
 
     ms50 += timeDifference_ms;
-    if(ms50 >= 50){
+    while(ms50 >= 50){
         ms50 -= 50;
         CO_NMT_blinkingProcess50ms(CO->NMT);
     }
     if(timerNext_ms != NULL){
-        if(*timerNext_ms > 50){
-            *timerNext_ms = 50;
+        if(*timerNext_ms > (50 - ms50)){
+            *timerNext_ms = 50 - ms50;
         }
     }
 
 
     for(i=0; i<CO_NO_SDO_SERVER; i++){
-        CO_SDO_process(
-                CO->SDO[i],
-                NMTisPreOrOperational,
-                timeDifference_ms,
-                1000,
-                timerNext_ms);
+        CO_SDO_t *SDO = CO->SDO[i];
+        uint16_t timeDifferenceSDO_ms = timeDifference_ms;
+        uint16_t timerNextSDO_ms;
+        uint8_t segments = 0;
+
+        /* Run SDO server to completion: process all pending work until it
+         * waits for the next message from the client or for free CAN
+         * transmit buffer. Block upload segments are sent back to back,
+         * CO_SDO_process() signals each one with timerNext_ms = 0. */
+        do{
+            timerNextSDO_ms = 0xFFFF;
+            if(CO_SDO_process(
+                    SDO,
+                    NMTisPreOrOperational,
+                    timeDifferenceSDO_ms,
+                    1000,
+                    &timerNextSDO_ms) != 1)
+            {
+                break;
+            }
+            timeDifferenceSDO_ms = 0;
+        }while((timerNextSDO_ms == 0 || SDO->CANrxNew) && !SDO->CANtxBuff->bufferFull && ++segments < 127U);
+
+        if(timerNext_ms != NULL && *timerNext_ms > timerNextSDO_ms){
+            *timerNext_ms = timerNextSDO_ms;
+        }
+
+        if(SDO->PDOchanged){
+            SDO->PDOchanged = false;
+            if(PDOchanged != NULL) *PDOchanged = true;
+        }
     }
 
     CO_EM_process(
             CO->emPr,
             NMTisPreOrOperational,
             timeDifference_ms * 10,
-            OD_inhibitTimeEMCY);
+            OD_inhibitTimeEMCY,
+            timerNext_ms);
 
 
     reset = CO_NMT_process(
@@ -662,7 +707,14 @@ CO_NMT_reset_cmd_t CO_process(
     CO_HBconsumer_process(
             CO->HBcons,
             NMTisPreOrOperational,
-            timeDifference_ms);
+            timeDifference_ms,
+            timerNext_ms);
+
+    /* NMT command or CO_NMT_process() starts or stops PDOs */
+    if(CO->NMT->operatingState != NMTstatePrev){
+        NMTstatePrev = CO->NMT->operatingState;
+        if(PDOchanged != NULL) *PDOchanged = true;
+    }
 
     return reset;
 }
@@ -671,12 +723,13 @@ CO_NMT_reset_cmd_t CO_process(
 /******************************************************************************/
 bool_t CO_process_SYNC_RPDO(
         CO_t                   *CO,
-        uint32_t                timeDifference_us)
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us)
 {
-    int16_t i;
+    CO_RPDO_t *RPDO;
     bool_t syncWas = false;
 
-    switch(CO_SYNC_process(CO->SYNC, timeDifference_us, OD_synchronousWindowLength)){
+    switch(CO_SYNC_process(CO->SYNC, timeDifference_us, OD_synchronousWindowLength, timerNext_us)){
         case 1:     //immediately after the SYNC message
             syncWas = true;
             break;
@@ -685,8 +738,15 @@ bool_t CO_process_SYNC_RPDO(
             break;
     }
 
-    for(i=0; i<CO_NO_RPDO; i++){
-        CO_RPDO_process(CO->RPDO[i], syncWas);
+    /* Only valid RPDOs are visited. Synchronous RPDOs are processed after
+     * SYNC, or if not operational, so their received data are discarded. */
+    for(RPDO=CO->PDOlists->RPDOasync; RPDO!=NULL; RPDO=RPDO->activeNext){
+        CO_RPDO_process(RPDO, syncWas);
+    }
+    if(syncWas || CO->NMT->operatingState != CO_NMT_OPERATIONAL){
+        for(RPDO=CO->PDOlists->RPDOsync; RPDO!=NULL; RPDO=RPDO->activeNext){
+            CO_RPDO_process(RPDO, syncWas);
+        }
     }
 
     return syncWas;
@@ -697,13 +757,68 @@ bool_t CO_process_SYNC_RPDO(
 void CO_process_TPDO(
         CO_t                   *CO,
         bool_t                  syncWas,
-        uint32_t                timeDifference_us)
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us)
 {
-    int16_t i;
+    CO_TPDO_t *TPDO;
+    uint32_t changedTPDOs;
+    bool_t operational = (CO->NMT->operatingState == CO_NMT_OPERATIONAL) ? true : false;
+
+    /* TPDOs, which map OD entries changed since previous call. If not
+     * operational, changes are kept, so acyclic synchronous TPDOs and Change
+     * of State see them after transition to operational. */
+    changedTPDOs = operational ? CO_OD_getChangedTPDOs(CO->SDO[0]) : 0U;
+
+    /* Verify Change Of State of valid event driven PDOs */
+    for(TPDO=CO->PDOlists->TPDOasync; TPDO!=NULL; TPDO=TPDO->activeNext){
+        CO_TPDO_processMap(TPDO, syncWas);
+        if(operational && !TPDO->sendRequest && (TPDO->ODTPDOMapBit == 0 || (changedTPDOs & TPDO->ODTPDOMapBit) != 0)){
+            if(CO_TPDOisCOS(TPDO)) CO_TPDOrequestSend(TPDO);
+        }
+    }
 
-    /* Verify PDO Change Of State and process PDOs */
-    for(i=0; i<CO_NO_TPDO; i++){
-        if(!CO->TPDO[i]->sendRequest) CO->TPDO[i]->sendRequest = CO_TPDOisCOS(CO->TPDO[i]);
-        CO_TPDO_process(CO->TPDO[i], CO->SYNC, syncWas, timeDifference_us);
+    /* Verify Change Of State of valid synchronous PDOs and process them */
+    for(TPDO=CO->PDOlists->TPDOsync; TPDO!=NULL; TPDO=TPDO->activeNext){
+        if(operational && !TPDO->sendRequest && (TPDO->ODTPDOMapBit == 0 || (changedTPDOs & TPDO->ODTPDOMapBit) != 0)){
+            TPDO->sendRequest = CO_TPDOisCOS(TPDO);
+        }
+        if(syncWas || !operational){
+            CO_TPDO_process(TPDO, CO->SYNC, syncWas);
+        }
+    }
+
+    /* Event driven PDOs with expired inhibit or event timer */
+    CO_TPDOtimers_process(CO->TPDOtimers, timeDifference_us, timerNext_us);
+}
+
+
+/******************************************************************************/
+void CO_TPDOsendChanged(CO_t *CO, uint16_t entryNo){
+    CO_SDO_t *SDO = CO->SDO[0];
+    CO_TPDO_t *TPDO;
+    uint32_t TPDOs;
+
+    if(entryNo >= SDO->ODSize) return;
+
+    CO_OD_markDirty(SDO, entryNo);
+
+    /* Only valid event driven TPDOs are visited. TPDOs without bit in the
+     * reverse index (TPDO 33 and above) may map any entry. */
+    TPDOs = (SDO->ODTPDOMap != NULL) ? SDO->ODTPDOMap[entryNo] : 0U;
+    for(TPDO=CO->PDOlists->TPDOasync; TPDO != NULL; TPDO=TPDO->activeNext){
+        if(TPDO->ODTPDOMapBit == 0 || (TPDOs & TPDO->ODTPDOMapBit) != 0){
+            bool_t COS;
+
+            /* Mapping and last sent data may be changed by the real time
+             * context. TPDO being sent elsewhere is verified later by
+             * CO_process_TPDO(), as the entry is marked dirty. */
+            CO_LOCK_PDO();
+            COS = (!TPDO->sending && CO_TPDOisCOS(TPDO)) ? true : false;
+            CO_UNLOCK_PDO();
+
+            if(COS){
+                CO_TPDOsendNow(TPDO);
+            }
+        }
     }
 }
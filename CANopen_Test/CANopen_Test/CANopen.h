@@ -133,6 +133,8 @@ typedef struct{
     CO_SYNC_t          *SYNC;           /**< SYNC object */
     CO_RPDO_t          *RPDO[CO_NO_RPDO];/**< RPDO objects */
     CO_TPDO_t          *TPDO[CO_NO_TPDO];/**< TPDO objects */
+    CO_TPDOtimers_t    *TPDOtimers;     /**< Timer queue of event driven TPDOs */
+    CO_PDOlists_t      *PDOlists;       /**< Lists of valid PDOs */
     CO_HBconsumer_t    *HBcons;         /**<  Heartbeat consumer object*/
 #if CO_NO_SDO_CLIENT == 1
     CO_SDOclient_t     *SDOclient;      /**< SDO client object */
@@ -165,10 +167,23 @@ typedef struct{
 #endif
 
 
+/**
+ * Size of static arena with all CANopen objects in bytes, see CO_init().
+ *
+ * Arena is placed in linker section by #CO_ARENA_SECTION, so its size is
+ * also visible in the map file. If CO_ARENA_MAX_SIZE is defined, bigger arena
+ * fails to compile. Value is also copied to OD_CANopenMemoryUsed, if it exists
+ * in Object Dictionary.
+ */
+extern const uint32_t CO_memoryUsed;
+
+
 /**
  * Initialize CANopen stack.
  *
- * Function must be called in the communication reset section.
+ * Function must be called in the communication reset section. CANopen objects
+ * are not allocated, they are placed in static arena, which is sized at
+ * compile time from CO_NO_* constants.
  *
  * @param CANbaseAddress Address of the CAN module, passed to CO_CANmodule_init().
  * @param nodeId Node ID of the CANopen device (1 ... 127).
@@ -184,7 +199,57 @@ CO_ReturnError_t CO_init(
 
 
 /**
- * Delete CANopen object and free memory. Must be called at program exit.
+ * Finish initialization of CANopen stack, which is not needed for boot-up.
+ *
+ * Function builds page table and descriptors of Object Dictionary, see
+ * CO_OD_buildTables(). It should be called from mainline after the first
+ * CO_process(), which sends boot-up message. Stack works without it, but
+ * Object Dictionary access is slower. Tables are kept by
+ * CO_resetCommunication().
+ *
+ * If Object Dictionary contains OD_bootTime, CO_init() and this function
+ * write there time of finished initialization phases in microseconds, see
+ * CO_TIMESTAMP_US().
+ */
+void CO_initDeferred(void);
+
+
+/**
+ * Store time of finished initialization phase (start, CANModuleInit,
+ * objectsInit, bootUp, deferredInit) into OD_bootTime, if it exists.
+ */
+#ifdef OD_bootTime
+    #define CO_BOOT_TIME(phase) OD_bootTime[ODA_bootTime_##phase] = CO_TIMESTAMP_US()
+#else
+    #define CO_BOOT_TIME(phase)
+#endif
+
+
+/**
+ * Fast communication reset of initialized CANopen stack.
+ *
+ * Function is called after NMT reset communication command instead of
+ * CO_delete() and CO_init(). CANopen objects are initialized again from
+ * communication parameters (0x1000 - 0x1FFF) in Object Dictionary and bind
+ * their CAN buffers in place, see CO_CANmodule_reset(). CAN controller, bit
+ * rate, hardware filters, memory arena and Object Dictionary tables (page
+ * table, descriptors and extensions) are kept. After the function,
+ * callbacks must be initialized again and CO_CANsetNormalMode() called. Boot-up
+ * message is sent by the next CO_process().
+ *
+ * @param nodeId Node ID of the CANopen device (1 ... 127).
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO, CO_ERROR_PARAMETERS or error from
+ * initialization of CANopen objects.
+ */
+CO_ReturnError_t CO_resetCommunication(uint8_t nodeId);
+
+
+/**
+ * Delete CANopen object. Must be called at program exit.
+ *
+ * CAN module is disabled. All CANopen objects are in static arena, so no
+ * memory is freed and CO_init() may be called again.
  *
  * @param CANbaseAddress Address of the CAN module, passed to CO_CANmodule_init().
  */
@@ -195,7 +260,10 @@ void CO_delete(struct can_async_descriptor *const  CANbaseAddress);
  * Process CANopen objects.
  *
  * Function must be called cyclically. It processes all "asynchronous" CANopen
- * objects.
+ * objects. SDO server is processed to completion: all received requests and
+ * all segments of block upload, which fit into CAN transmit buffers, are
+ * handled in one call. For full bus rate SDO transfer, call this function
+ * also from the SDO pFunctSignal (see CO_SDO_initCallback()).
  *
  * @param CO This object
  * @param timeDifference_ms Time difference from previous function call in [milliseconds].
@@ -205,13 +273,20 @@ void CO_delete(struct can_async_descriptor *const  CANbaseAddress);
  *        Output will be equal or lower to initial value. If there is new object
  *        to process, delay should be suspended and this function should be
  *        called immediately. Parameter is ignored if NULL.
+ * @param PDOchanged Return value - set to true, if SDO server changed SYNC or
+ *        TPDO parameters or OD entries mapped to TPDO (see
+ *        CO_SDO_t::PDOchanged), or if NMT state changed. Real time context
+ *        (CO_process_SYNC_RPDO() and CO_process_TPDO()) should run then
+ *        without waiting for its deadline. Unchanged otherwise. Parameter is
+ *        ignored if NULL.
  *
  * @return #CO_NMT_reset_cmd_t from CO_NMT_process().
  */
 CO_NMT_reset_cmd_t CO_process(
         CO_t                   *CO,
         uint16_t                timeDifference_ms,
-        uint16_t               *timerNext_ms);
+        uint16_t               *timerNext_ms,
+        bool_t                 *PDOchanged);
 
 
 /**
@@ -222,12 +297,16 @@ CO_NMT_reset_cmd_t CO_process(
  *
  * @param CO This object.
  * @param timeDifference_us Time difference from previous function call in [microseconds].
+ * @param timerNext_us Return value - info to OS - maximum delay after function
+ *        should be called next time in [microseconds]. Same rules as for
+ *        timerNext_ms in CO_process(). Parameter is ignored if NULL.
  *
  * @return True, if CANopen SYNC message was just received or transmitted.
  */
 bool_t CO_process_SYNC_RPDO(
         CO_t                   *CO,
-        uint32_t                timeDifference_us);
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us);
 
 
 /**
@@ -235,15 +314,36 @@ bool_t CO_process_SYNC_RPDO(
  *
  * Function must be called cyclically from real time thread with constant.
  * interval (1ms typically). It processes transmit PDO CANopen objects.
+ * Change of State is verified only for TPDOs, which map OD entries marked as
+ * changed by CO_OD_markDirty(). Event driven TPDOs are sent from the timer
+ * queue, see CO_TPDOtimers_process().
  *
  * @param CO This object.
  * @param syncWas True, if CANopen SYNC message was just received or transmitted.
  * @param timeDifference_us Time difference from previous function call in [microseconds].
+ * @param timerNext_us Return value - info to OS - see CO_process_SYNC_RPDO().
  */
 void CO_process_TPDO(
         CO_t                   *CO,
         bool_t                  syncWas,
-        uint32_t                timeDifference_us);
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us);
+
+
+/**
+ * Send event driven TPDOs, which map changed OD entry, immediately.
+ *
+ * Application may call it after it writes OD variable with Change of State
+ * detection, also from interrupt. Entry is marked by CO_OD_markDirty() and
+ * TPDOs with transmission type 254 or 255, which detect Change of State, are
+ * sent by CO_TPDOsendNow() without waiting for CO_process_TPDO(). Change of
+ * State is verified under CO_LOCK_PDO(). TPDOs above 32 have no bit in the
+ * reverse index, so they are verified on change of any entry.
+ *
+ * @param CO This object.
+ * @param entryNo Sequence number of OD entry, ODE_xxx from CO_OD.h.
+ */
+void CO_TPDOsendChanged(CO_t *CO, uint16_t entryNo);
 
 #ifdef __cplusplus
 }
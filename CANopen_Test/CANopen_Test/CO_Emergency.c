@@ -197,7 +197,8 @@ void CO_EM_process(
         CO_EMpr_t              *emPr,
         bool_t                  NMTisPreOrOperational,
         uint16_t                timeDifference_100us,
-        uint16_t                emInhTime)
+        uint16_t                emInhTime,
+        uint16_t               *timerNext_ms)
 {
 
     CO_EM_t *em = emPr->em;
@@ -274,6 +275,20 @@ void CO_EM_process(
         CO_CANsend(emPr->CANdev, emPr->CANtxBuff);
     }
 
+    /* Calculate, when next Emergency message may be sent and lower timerNext_ms if necessary. */
+    if(timerNext_ms != NULL && NMTisPreOrOperational &&
+            (em->bufReadPtr != em->bufWritePtr || em->bufFull))
+    {
+        uint16_t diff = emPr->CANtxBuff->bufferFull ? 1U : 0U;
+        if(emPr->inhibitEmTimer < emInhTime){
+            /* round up from [100 * microseconds] to [milliseconds] */
+            diff = (uint16_t)((emInhTime - emPr->inhibitEmTimer + 9U) / 10U);
+        }
+        if(*timerNext_ms > diff){
+            *timerNext_ms = diff;
+        }
+    }
+
     return;
 }
 
@@ -205,7 +205,8 @@ CO_ReturnError_t CO_HBconsumer_init(
 void CO_HBconsumer_process(
         CO_HBconsumer_t        *HBcons,
         bool_t                  NMTisPreOrOperational,
-        uint16_t                timeDifference_ms)
+        uint16_t                timeDifference_ms,
+        uint16_t               *timerNext_ms)
 {
     uint8_t i;
     uint8_t AllMonitoredOperationalCopy;
@@ -239,6 +240,14 @@ void CO_HBconsumer_process(
                         /* there was a bootup message */
                         CO_errorReport(HBcons->em, CO_EM_HB_CONSUMER_REMOTE_RESET, CO_EMC_HEARTBEAT, i);
                     }
+
+                    /* Calculate, when Heartbeat timeout expires and lower timerNext_ms if necessary. */
+                    if(timerNext_ms != NULL && monitoredNode->timeoutTimer < monitoredNode->time){
+                        uint16_t diff = monitoredNode->time - monitoredNode->timeoutTimer;
+                        if(*timerNext_ms > diff){
+                            *timerNext_ms = diff;
+                        }
+                    }
                 }
                 if(monitoredNode->NMTstate != CO_NMT_OPERATIONAL)
                     AllMonitoredOperationalCopy = 0;
@@ -1,11 +1,8 @@
 /*
  * CANopen Object Dictionary.
  *
- * This file was automatically generated with CANopenNode Object
- * Dictionary Editor. DON'T EDIT THIS FILE MANUALLY !!!!
- * Object Dictionary Editor is currently an older, but functional web
- * application. For more info see See 'Object_Dictionary_Editor/about.html' in
- * <http://sourceforge.net/p/canopennode/code_complete/ci/master/tree/>
+ * This file was automatically generated with eds2co_od.py from CO_OD.eds.
+ * DON'T EDIT THIS FILE MANUALLY !!!!
  * For more information on CANopen Object Dictionary see <CO_SDO.h>.
  *
  * @file        CO_OD.c
@@ -49,7 +46,6 @@
  * to do so, delete this exception statement from your version.
  */
 
-
 #include "CO_driver.h"
 #include "CO_OD.h"
 #include "CO_SDO.h"
@@ -58,29 +54,30 @@
 /*******************************************************************************
    DEFINITION AND INITIALIZATION OF OBJECT DICTIONARY VARIABLES
 *******************************************************************************/
-
 /***** Definition for RAM variables *******************************************/
 struct sCO_OD_RAM CO_OD_RAM = {
            CO_OD_FIRST_LAST_WORD,
 
-/*1001*/ 0x0,
+/*2120*/ {0x1234567890ABCDEFLL, 0x234567890ABCDEF1LL, 456.789, 12.345, 0x5, 0},
+/*2130*/ {0LL, 0x0L, 0x3, {'-', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '}},
 /*1002*/ 0x0L,
 /*1003*/ {0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1010*/ {0x3L},
 /*1011*/ {0x1L},
-/*2100*/ {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+/*2105*/ 0x0L,
+/*2110*/ {0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L},
+/*2113*/ {0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*2103*/ 0x0,
 /*2104*/ 0x0,
 /*2107*/ {0x3E8, 0x0, 0x0, 0x0, 0x0},
 /*2108*/ {0},
 /*2109*/ {0},
-/*2110*/ {0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L},
-/*2120*/ {0x5, 0x1234567890ABCDEFLL, 0x234567890ABCDEF1LL, 12.345, 456.789, 0},
-/*2130*/ {0x3, {'-', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '}, 0, 0x0L},
-/*6000*/ {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-/*6200*/ {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
 /*6401*/ {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
 /*6411*/ {0, 0, 0, 0, 0, 0, 0, 0},
+/*1001*/ 0x0,
+/*2100*/ {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+/*6000*/ {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
+/*6200*/ {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
 
            CO_OD_FIRST_LAST_WORD,
 };
@@ -98,23 +95,16 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
 
 
 /***** Definition for ROM variables *******************************************/
-   struct sCO_OD_ROM CO_OD_ROM = {    //constant variables, stored in flash
+struct sCO_OD_ROM CO_OD_ROM = {
            CO_OD_FIRST_LAST_WORD,
 
 /*1000*/ 0x0L,
 /*1005*/ 0x80L,
 /*1006*/ 0x0L,
 /*1007*/ 0x0L,
-/*1008*/ {'C', 'A', 'N', 'o', 'p', 'e', 'n', 'N', 'o', 'd', 'e'},
-/*1009*/ {'3', '.', '0', '0'},
-/*100A*/ {'3', '.', '0', '0'},
 /*1014*/ 0x80L,
-/*1015*/ 0x64,
 /*1016*/ {0x0L, 0x0L, 0x0L, 0x0L},
-/*1017*/ 0x3E8,
 /*1018*/ {0x4, 0x0L, 0x0L, 0x0L, 0x0L},
-/*1019*/ 0x0,
-/*1029*/ {0x0, 0x0, 0x1, 0x0, 0x0, 0x0},
 /*1200*/{{0x2, 0x600L, 0x580L}},
 /*1400*/{{0x2, 0x200L, 0xFF},
 /*1401*/ {0x2, 0x300L, 0xFE},
@@ -133,11 +123,19 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
 /*1A02*/ {0x0, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L},
 /*1A03*/ {0x0, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L, 0x0L}},
 /*1F80*/ 0x0L,
-/*2101*/ 0x30,
-/*2102*/ 0xFA,
 /*2111*/ {1L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L},
+/*6426*/ {0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L},
+/*1015*/ 0x64,
+/*1017*/ 0x3E8,
+/*2102*/ 0xFA,
+/*1008*/ {'C', 'A', 'N', 'o', 'p', 'e', 'n', 'N', 'o', 'd', 'e'},
+/*1009*/ {'3', '.', '0', '0'},
+/*100A*/ {'3', '.', '0', '0'},
+/*1019*/ 0x0,
+/*1029*/ {0x0, 0x0, 0x1, 0x0, 0x0, 0x0},
+/*2101*/ 0x30,
 
-           CO_OD_FIRST_LAST_WORD
+           CO_OD_FIRST_LAST_WORD,
 };
 
 
@@ -284,7 +282,7 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
            {(void*)&CO_OD_ROM.TPDOMappingParameter[3].mappedObject8, 0x8D,  4}};
 /*0x2120*/ const CO_OD_entryRecord_t OD_record2120[6] = {
            {(void*)&CO_OD_RAM.testVar.maxSubIndex, 0x06,  1},
-           {(void*)&CO_OD_RAM.testVar.I64, 0xBE,  8},
+           {(void*)&CO_OD_RAM.testVar.I64, 0x1BE,  8},
            {(void*)&CO_OD_RAM.testVar.U64, 0xBE,  8},
            {(void*)&CO_OD_RAM.testVar.R32, 0xBE,  4},
            {(void*)&CO_OD_RAM.testVar.R64, 0xBE,  8},
@@ -342,18 +340,21 @@ const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {
 {0x2102, 0x00, 0x8D,  2, (void*)&CO_OD_ROM.CANBitRate},
 {0x2103, 0x00, 0x8E,  2, (void*)&CO_OD_RAM.SYNCCounter},
 {0x2104, 0x00, 0x86,  2, (void*)&CO_OD_RAM.SYNCTime},
+{0x2105, 0x00, 0x86,  4, (void*)&CO_OD_RAM.CANopenMemoryUsed},
 {0x2106, 0x00, 0x87,  4, (void*)&CO_OD_EEPROM.powerOnCounter},
 {0x2107, 0x05, 0xBE,  2, (void*)&CO_OD_RAM.performance[0]},
-{0x2108, 0x01, 0xB6,  2, (void*)&CO_OD_RAM.temperature[0]},
-{0x2109, 0x01, 0xB6,  2, (void*)&CO_OD_RAM.voltage[0]},
-{0x2110, 0x10, 0xFE,  4, (void*)&CO_OD_RAM.variableInt32[0]},
-{0x2111, 0x10, 0xFD,  4, (void*)&CO_OD_ROM.variableROMInt32[0]},
-{0x2112, 0x10, 0xFF,  4, (void*)&CO_OD_EEPROM.variableNVInt32[0]},
+{0x2108, 0x01, 0x1B6,  2, (void*)&CO_OD_RAM.temperature[0]},
+{0x2109, 0x01, 0x1B6,  2, (void*)&CO_OD_RAM.voltage[0]},
+{0x2110, 0x10, 0x1FE,  4, (void*)&CO_OD_RAM.variableInt32[0]},
+{0x2111, 0x10, 0x1FD,  4, (void*)&CO_OD_ROM.variableROMInt32[0]},
+{0x2112, 0x10, 0x1FF,  4, (void*)&CO_OD_EEPROM.variableNVInt32[0]},
+{0x2113, 0x05, 0x86,  4, (void*)&CO_OD_RAM.bootTime[0]},
 {0x2120, 0x05, 0x00,  0, (void*)&OD_record2120},
 {0x2130, 0x03, 0x00,  0, (void*)&OD_record2130},
 {0x6000, 0x08, 0x76,  1, (void*)&CO_OD_RAM.readInput8Bit[0]},
 {0x6200, 0x08, 0x3E,  1, (void*)&CO_OD_RAM.writeOutput8Bit[0]},
-{0x6401, 0x0C, 0xB6,  2, (void*)&CO_OD_RAM.readAnalogueInput16Bit[0]},
-{0x6411, 0x08, 0xBE,  2, (void*)&CO_OD_RAM.writeAnalogueOutput16Bit[0]},
+{0x6401, 0x0C, 0x1F6,  2, (void*)&CO_OD_RAM.readAnalogueInput16Bit[0]},
+{0x6411, 0x08, 0x1BE,  2, (void*)&CO_OD_RAM.writeAnalogueOutput16Bit[0]},
+{0x6426, 0x0C, 0x8D,  4, (void*)&CO_OD_ROM.analogueInputInterruptDeltaUnsigned[0]},
 };
 
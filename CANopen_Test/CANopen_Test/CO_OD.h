@@ -1,11 +1,8 @@
 /*
  * CANopen Object Dictionary.
  *
- * This file was automatically generated with CANopenNode Object
- * Dictionary Editor. DON'T EDIT THIS FILE MANUALLY !!!!
- * Object Dictionary Editor is currently an older, but functional web
- * application. For more info see See 'Object_Dictionary_Editor/about.html' in
- * <http://sourceforge.net/p/canopennode/code_complete/ci/master/tree/>
+ * This file was automatically generated with eds2co_od.py from CO_OD.eds.
+ * DON'T EDIT THIS FILE MANUALLY !!!!
  * For more information on CANopen Object Dictionary see <CO_SDO.h>.
  *
  * @file        CO_OD.h
@@ -82,8 +79,8 @@
 
 /*******************************************************************************
    FILE INFO:
-      FileName:     IO Example
-      FileVersion:  -
+      FileName:     CO_OD.eds
+      FileVersion:  1
       CreationTime: 18:04:29
       CreationDate: 2016-03-25
       CreatedBy:    JP
@@ -115,7 +112,8 @@
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-   #define CO_OD_NoOfElements             55
+   #define CO_OD_NoOfElements             58
+   #define CO_OD_NoOfSubIndexes           296
 
 
 /*******************************************************************************
@@ -176,19 +174,19 @@
                }              OD_TPDOMappingParameter_t;
 
 /*2120      */ typedef struct{
-               UNSIGNED8      maxSubIndex;
                INTEGER64      I64;
                UNSIGNED64     U64;
-               REAL32         R32;
                REAL64         R64;
+               REAL32         R32;
+               UNSIGNED8      maxSubIndex;
                DOMAIN         domain;
                }              OD_testVar_t;
 
 /*2130      */ typedef struct{
-               UNSIGNED8      maxSubIndex;
-               VISIBLE_STRING string[30];
                UNSIGNED64     epochTimeBaseMs;
                UNSIGNED32     epochTimeOffsetMs;
+               UNSIGNED8      maxSubIndex;
+               VISIBLE_STRING string[30];
                }              OD_time_t;
 
 
@@ -201,24 +199,26 @@
 struct sCO_OD_RAM{
                UNSIGNED32     FirstWord;
 
-/*1001      */ UNSIGNED8      errorRegister;
+/*2120      */ OD_testVar_t   testVar;
+/*2130      */ OD_time_t      time;
 /*1002      */ UNSIGNED32     manufacturerStatusRegister;
 /*1003      */ UNSIGNED32     preDefinedErrorField[8];
 /*1010      */ UNSIGNED32     storeParameters[1];
 /*1011      */ UNSIGNED32     restoreDefaultParameters[1];
-/*2100      */ OCTET_STRING   errorStatusBits[10];
+/*2105      */ UNSIGNED32     CANopenMemoryUsed;
+/*2110      */ INTEGER32      variableInt32[16];
+/*2113      */ UNSIGNED32     bootTime[5];
 /*2103      */ UNSIGNED16     SYNCCounter;
 /*2104      */ UNSIGNED16     SYNCTime;
 /*2107      */ UNSIGNED16     performance[5];
 /*2108      */ INTEGER16      temperature[1];
 /*2109      */ INTEGER16      voltage[1];
-/*2110      */ INTEGER32      variableInt32[16];
-/*2120      */ OD_testVar_t   testVar;
-/*2130      */ OD_time_t      time;
-/*6000      */ UNSIGNED8      readInput8Bit[8];
-/*6200      */ UNSIGNED8      writeOutput8Bit[8];
 /*6401      */ INTEGER16      readAnalogueInput16Bit[12];
 /*6411      */ INTEGER16      writeAnalogueOutput16Bit[8];
+/*1001      */ UNSIGNED8      errorRegister;
+/*2100      */ OCTET_STRING   errorStatusBits[10];
+/*6000      */ UNSIGNED8      readInput8Bit[8];
+/*6200      */ UNSIGNED8      writeOutput8Bit[8];
 
                UNSIGNED32     LastWord;
 };
@@ -233,7 +233,6 @@ struct sCO_OD_EEPROM{
                UNSIGNED32     LastWord;
 };
 
-
 /***** Structure for ROM variables ********************************************/
 struct sCO_OD_ROM{
                UNSIGNED32     FirstWord;
@@ -242,25 +241,26 @@ struct sCO_OD_ROM{
 /*1005      */ UNSIGNED32     COB_ID_SYNCMessage;
 /*1006      */ UNSIGNED32     communicationCyclePeriod;
 /*1007      */ UNSIGNED32     synchronousWindowLength;
-/*1008      */ VISIBLE_STRING manufacturerDeviceName[11];
-/*1009      */ VISIBLE_STRING manufacturerHardwareVersion[4];
-/*100A      */ VISIBLE_STRING manufacturerSoftwareVersion[4];
 /*1014      */ UNSIGNED32     COB_ID_EMCY;
-/*1015      */ UNSIGNED16     inhibitTimeEMCY;
 /*1016      */ UNSIGNED32     consumerHeartbeatTime[4];
-/*1017      */ UNSIGNED16     producerHeartbeatTime;
 /*1018      */ OD_identity_t  identity;
-/*1019      */ UNSIGNED8      synchronousCounterOverflowValue;
-/*1029      */ UNSIGNED8      errorBehavior[6];
 /*1200[1]   */ OD_SDOServerParameter_t SDOServerParameter[1];
 /*1400[4]   */ OD_RPDOCommunicationParameter_t RPDOCommunicationParameter[4];
 /*1600[4]   */ OD_RPDOMappingParameter_t RPDOMappingParameter[4];
 /*1800[4]   */ OD_TPDOCommunicationParameter_t TPDOCommunicationParameter[4];
 /*1A00[4]   */ OD_TPDOMappingParameter_t TPDOMappingParameter[4];
 /*1F80      */ UNSIGNED32     NMTStartup;
-/*2101      */ UNSIGNED8      CANNodeID;
-/*2102      */ UNSIGNED16     CANBitRate;
 /*2111      */ INTEGER32      variableROMInt32[16];
+/*6426      */ UNSIGNED32     analogueInputInterruptDeltaUnsigned[12];
+/*1015      */ UNSIGNED16     inhibitTimeEMCY;
+/*1017      */ UNSIGNED16     producerHeartbeatTime;
+/*2102      */ UNSIGNED16     CANBitRate;
+/*1008      */ VISIBLE_STRING manufacturerDeviceName[11];
+/*1009      */ VISIBLE_STRING manufacturerHardwareVersion[4];
+/*100A      */ VISIBLE_STRING manufacturerSoftwareVersion[4];
+/*1019      */ UNSIGNED8      synchronousCounterOverflowValue;
+/*1029      */ UNSIGNED8      errorBehavior[6];
+/*2101      */ UNSIGNED8      CANNodeID;
 
                UNSIGNED32     LastWord;
 };
@@ -279,69 +279,88 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 *******************************************************************************/
 /*1000, Data Type: UNSIGNED32 */
       #define OD_deviceType                              CO_OD_ROM.deviceType
+      #define ODE_deviceType                             0
 
 /*1001, Data Type: UNSIGNED8 */
       #define OD_errorRegister                           CO_OD_RAM.errorRegister
+      #define ODE_errorRegister                          1
 
 /*1002, Data Type: UNSIGNED32 */
       #define OD_manufacturerStatusRegister              CO_OD_RAM.manufacturerStatusRegister
+      #define ODE_manufacturerStatusRegister             2
 
 /*1003, Data Type: UNSIGNED32, Array[8] */
       #define OD_preDefinedErrorField                    CO_OD_RAM.preDefinedErrorField
+      #define ODE_preDefinedErrorField                   3
       #define ODL_preDefinedErrorField_arrayLength       8
 
 /*1005, Data Type: UNSIGNED32 */
       #define OD_COB_ID_SYNCMessage                      CO_OD_ROM.COB_ID_SYNCMessage
+      #define ODE_COB_ID_SYNCMessage                     4
 
 /*1006, Data Type: UNSIGNED32 */
       #define OD_communicationCyclePeriod                CO_OD_ROM.communicationCyclePeriod
+      #define ODE_communicationCyclePeriod               5
 
 /*1007, Data Type: UNSIGNED32 */
       #define OD_synchronousWindowLength                 CO_OD_ROM.synchronousWindowLength
+      #define ODE_synchronousWindowLength                6
 
 /*1008, Data Type: VISIBLE_STRING, Array[11] */
       #define OD_manufacturerDeviceName                  CO_OD_ROM.manufacturerDeviceName
+      #define ODE_manufacturerDeviceName                 7
       #define ODL_manufacturerDeviceName_stringLength    11
 
 /*1009, Data Type: VISIBLE_STRING, Array[4] */
       #define OD_manufacturerHardwareVersion             CO_OD_ROM.manufacturerHardwareVersion
+      #define ODE_manufacturerHardwareVersion            8
       #define ODL_manufacturerHardwareVersion_stringLength 4
 
 /*100A, Data Type: VISIBLE_STRING, Array[4] */
       #define OD_manufacturerSoftwareVersion             CO_OD_ROM.manufacturerSoftwareVersion
+      #define ODE_manufacturerSoftwareVersion            9
       #define ODL_manufacturerSoftwareVersion_stringLength 4
 
 /*1010, Data Type: UNSIGNED32, Array[1] */
       #define OD_storeParameters                         CO_OD_RAM.storeParameters
+      #define ODE_storeParameters                        10
       #define ODL_storeParameters_arrayLength            1
       #define ODA_storeParameters_saveAllParameters      0
 
 /*1011, Data Type: UNSIGNED32, Array[1] */
       #define OD_restoreDefaultParameters                CO_OD_RAM.restoreDefaultParameters
+      #define ODE_restoreDefaultParameters               11
       #define ODL_restoreDefaultParameters_arrayLength   1
       #define ODA_restoreDefaultParameters_restoreAllDefaultParameters 0
 
 /*1014, Data Type: UNSIGNED32 */
       #define OD_COB_ID_EMCY                             CO_OD_ROM.COB_ID_EMCY
+      #define ODE_COB_ID_EMCY                            12
 
 /*1015, Data Type: UNSIGNED16 */
       #define OD_inhibitTimeEMCY                         CO_OD_ROM.inhibitTimeEMCY
+      #define ODE_inhibitTimeEMCY                        13
 
 /*1016, Data Type: UNSIGNED32, Array[4] */
       #define OD_consumerHeartbeatTime                   CO_OD_ROM.consumerHeartbeatTime
+      #define ODE_consumerHeartbeatTime                  14
       #define ODL_consumerHeartbeatTime_arrayLength      4
 
 /*1017, Data Type: UNSIGNED16 */
       #define OD_producerHeartbeatTime                   CO_OD_ROM.producerHeartbeatTime
+      #define ODE_producerHeartbeatTime                  15
 
 /*1018, Data Type: OD_identity_t */
       #define OD_identity                                CO_OD_ROM.identity
+      #define ODE_identity                               16
 
 /*1019, Data Type: UNSIGNED8 */
       #define OD_synchronousCounterOverflowValue         CO_OD_ROM.synchronousCounterOverflowValue
+      #define ODE_synchronousCounterOverflowValue        17
 
 /*1029, Data Type: UNSIGNED8, Array[6] */
       #define OD_errorBehavior                           CO_OD_ROM.errorBehavior
+      #define ODE_errorBehavior                          18
       #define ODL_errorBehavior_arrayLength              6
       #define ODA_errorBehavior_communication            0
       #define ODA_errorBehavior_communicationOther       1
@@ -352,43 +371,60 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 
 /*1200[1], Data Type: OD_SDOServerParameter_t, Array[1] */
       #define OD_SDOServerParameter                      CO_OD_ROM.SDOServerParameter
+      #define ODE_SDOServerParameter                     19
 
 /*1400[4], Data Type: OD_RPDOCommunicationParameter_t, Array[4] */
       #define OD_RPDOCommunicationParameter              CO_OD_ROM.RPDOCommunicationParameter
+      #define ODE_RPDOCommunicationParameter             20
 
 /*1600[4], Data Type: OD_RPDOMappingParameter_t, Array[4] */
       #define OD_RPDOMappingParameter                    CO_OD_ROM.RPDOMappingParameter
+      #define ODE_RPDOMappingParameter                   24
 
 /*1800[4], Data Type: OD_TPDOCommunicationParameter_t, Array[4] */
       #define OD_TPDOCommunicationParameter              CO_OD_ROM.TPDOCommunicationParameter
+      #define ODE_TPDOCommunicationParameter             28
 
 /*1A00[4], Data Type: OD_TPDOMappingParameter_t, Array[4] */
       #define OD_TPDOMappingParameter                    CO_OD_ROM.TPDOMappingParameter
+      #define ODE_TPDOMappingParameter                   32
 
 /*1F80, Data Type: UNSIGNED32 */
       #define OD_NMTStartup                              CO_OD_ROM.NMTStartup
+      #define ODE_NMTStartup                             36
 
 /*2100, Data Type: OCTET_STRING, Array[10] */
       #define OD_errorStatusBits                         CO_OD_RAM.errorStatusBits
+      #define ODE_errorStatusBits                        37
       #define ODL_errorStatusBits_stringLength           10
 
 /*2101, Data Type: UNSIGNED8 */
       #define OD_CANNodeID                               CO_OD_ROM.CANNodeID
+      #define ODE_CANNodeID                              38
 
 /*2102, Data Type: UNSIGNED16 */
       #define OD_CANBitRate                              CO_OD_ROM.CANBitRate
+      #define ODE_CANBitRate                             39
 
 /*2103, Data Type: UNSIGNED16 */
       #define OD_SYNCCounter                             CO_OD_RAM.SYNCCounter
+      #define ODE_SYNCCounter                            40
 
 /*2104, Data Type: UNSIGNED16 */
       #define OD_SYNCTime                                CO_OD_RAM.SYNCTime
+      #define ODE_SYNCTime                               41
+
+/*2105, Data Type: UNSIGNED32 */
+      #define OD_CANopenMemoryUsed                       CO_OD_RAM.CANopenMemoryUsed
+      #define ODE_CANopenMemoryUsed                      42
 
 /*2106, Data Type: UNSIGNED32 */
       #define OD_powerOnCounter                          CO_OD_EEPROM.powerOnCounter
+      #define ODE_powerOnCounter                         43
 
 /*2107, Data Type: UNSIGNED16, Array[5] */
       #define OD_performance                             CO_OD_RAM.performance
+      #define ODE_performance                            44
       #define ODL_performance_arrayLength                5
       #define ODA_performance_cyclesPerSecond            0
       #define ODA_performance_timerCycleTime             1
@@ -398,48 +434,73 @@ extern struct sCO_OD_ROM CO_OD_ROM;
 
 /*2108, Data Type: INTEGER16, Array[1] */
       #define OD_temperature                             CO_OD_RAM.temperature
+      #define ODE_temperature                            45
       #define ODL_temperature_arrayLength                1
       #define ODA_temperature_mainPCB                    0
 
 /*2109, Data Type: INTEGER16, Array[1] */
       #define OD_voltage                                 CO_OD_RAM.voltage
+      #define ODE_voltage                                46
       #define ODL_voltage_arrayLength                    1
       #define ODA_voltage_mainPCBSupply                  0
 
 /*2110, Data Type: INTEGER32, Array[16] */
       #define OD_variableInt32                           CO_OD_RAM.variableInt32
+      #define ODE_variableInt32                          47
       #define ODL_variableInt32_arrayLength              16
 
 /*2111, Data Type: INTEGER32, Array[16] */
       #define OD_variableROMInt32                        CO_OD_ROM.variableROMInt32
+      #define ODE_variableROMInt32                       48
       #define ODL_variableROMInt32_arrayLength           16
 
 /*2112, Data Type: INTEGER32, Array[16] */
       #define OD_variableNVInt32                         CO_OD_EEPROM.variableNVInt32
+      #define ODE_variableNVInt32                        49
       #define ODL_variableNVInt32_arrayLength            16
 
+/*2113, Data Type: UNSIGNED32, Array[5] */
+      #define OD_bootTime                                CO_OD_RAM.bootTime
+      #define ODE_bootTime                               50
+      #define ODL_bootTime_arrayLength                   5
+      #define ODA_bootTime_start                         0
+      #define ODA_bootTime_CANModuleInit                 1
+      #define ODA_bootTime_objectsInit                   2
+      #define ODA_bootTime_bootUp                        3
+      #define ODA_bootTime_deferredInit                  4
+
 /*2120, Data Type: OD_testVar_t */
       #define OD_testVar                                 CO_OD_RAM.testVar
+      #define ODE_testVar                                51
 
 /*2130, Data Type: OD_time_t */
       #define OD_time                                    CO_OD_RAM.time
+      #define ODE_time                                   52
 
 /*6000, Data Type: UNSIGNED8, Array[8] */
       #define OD_readInput8Bit                           CO_OD_RAM.readInput8Bit
+      #define ODE_readInput8Bit                          53
       #define ODL_readInput8Bit_arrayLength              8
 
 /*6200, Data Type: UNSIGNED8, Array[8] */
       #define OD_writeOutput8Bit                         CO_OD_RAM.writeOutput8Bit
+      #define ODE_writeOutput8Bit                        54
       #define ODL_writeOutput8Bit_arrayLength            8
 
 /*6401, Data Type: INTEGER16, Array[12] */
       #define OD_readAnalogueInput16Bit                  CO_OD_RAM.readAnalogueInput16Bit
+      #define ODE_readAnalogueInput16Bit                 55
       #define ODL_readAnalogueInput16Bit_arrayLength     12
 
 /*6411, Data Type: INTEGER16, Array[8] */
       #define OD_writeAnalogueOutput16Bit                CO_OD_RAM.writeAnalogueOutput16Bit
+      #define ODE_writeAnalogueOutput16Bit               56
       #define ODL_writeAnalogueOutput16Bit_arrayLength   8
 
+/*6426, Data Type: UNSIGNED32, Array[12] */
+      #define OD_analogueInputInterruptDeltaUnsigned     CO_OD_ROM.analogueInputInterruptDeltaUnsigned
+      #define ODE_analogueInputInterruptDeltaUnsigned    57
+      #define ODL_analogueInputInterruptDeltaUnsigned_arrayLength 12
 
-#endif
 
+#endif
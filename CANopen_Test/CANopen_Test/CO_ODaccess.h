@@ -0,0 +1,203 @@
+/**
+ * CANopen Object Dictionary access from application.
+ *
+ * @file        CO_ODaccess.h
+ * @ingroup     CO_ODaccess
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free and open source software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Following clarification and special exception to the GNU General Public
+ * License is included to the distribution terms of CANopenNode:
+ *
+ * Linking this library statically or dynamically with other modules is
+ * making a combined work based on this library. Thus, the terms and
+ * conditions of the GNU General Public License cover the whole combination.
+ *
+ * As a special exception, the copyright holders of this library give
+ * you permission to link this library with independent modules to
+ * produce an executable, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting
+ * executable under terms of your choice, provided that you also meet,
+ * for each linked independent module, the terms and conditions of the
+ * license of that module. An independent module is a module which is
+ * not derived from or based on this library. If you modify this
+ * library, you may extend this exception to your version of the
+ * library, but you are not obliged to do so. If you do not wish
+ * to do so, delete this exception statement from your version.
+ */
+
+
+#ifndef CO_ODACCESS_H
+#define CO_ODACCESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CO_driver.h"
+#include "CO_SDO.h"
+#include "CO_OD.h"
+
+
+/**
+ * @defgroup CO_ODaccess OD access
+ * @ingroup CO_CANopen
+ * @{
+ *
+ * Typed access to Object Dictionary variables from application.
+ *
+ * Object is selected by its name from CO_OD.h, without the OD_ prefix, for
+ * example _readInput8Bit_ for OD_readInput8Bit. Variable and its OD entry
+ * number (ODE_ macro, generated together with CO_OD.h) are both resolved at
+ * compile time, so no CO_OD_find() is needed.
+ *
+ * Type is CANopen data type from CO_OD.h (UNSIGNED8, INTEGER16, REAL32, ...).
+ * Compilation fails, if size of type differs from size of variable. Variables
+ * of 8, 16 and 32 bits are read and written with single instruction, which is
+ * atomic against PDO processing in interrupt. Wider variables and whole
+ * records are accessed with sequence counter of the OD entry, see
+ * CO_OD_readBegin(), without disabling interrupts.
+ *
+ * Setters mark OD entry as changed with CO_OD_markDirty(), so TPDOs, which map
+ * the variable with change of state detection, are triggered.
+ *
+ * \code{.c}
+ * uint8_t inputs = readInputs();
+ * CO_OD_SET_ARR(UNSIGNED8, CO->SDO[0], readInput8Bit, 0, inputs);
+ * writeOutputs(CO_OD_GET_ARR(UNSIGNED8, writeOutput8Bit, 0));
+ * \endcode
+ */
+
+
+/**
+ * Verify at compile time, that OD variable has size of type and that it can be
+ * accessed with single instruction. Value of the expression is 0.
+ */
+#define CO_OD_CHECK(type, var) \
+    (0U * sizeof(char[((sizeof(var) == sizeof(type)) && (sizeof(type) <= 4U)) ? 1 : -1]))
+
+
+/**
+ * Read OD variable of 8, 16 or 32 bits.
+ *
+ * @param type CANopen data type.
+ * @param var OD variable (lvalue).
+ *
+ * @return Value of the variable.
+ */
+#define CO_OD_LOAD(type, var) \
+    ((void)CO_OD_CHECK(type, var), *(volatile const type *)&(var))
+
+
+/**
+ * Write OD variable of 8, 16 or 32 bits. OD entry is not marked as changed.
+ *
+ * @param type CANopen data type.
+ * @param var OD variable (lvalue).
+ * @param value New value.
+ */
+#define CO_OD_STORE(type, var, value) \
+    ((void)CO_OD_CHECK(type, var), (void)(*(volatile type *)&(var) = (type)(value)))
+
+
+/** Read OD variable _name_. */
+#define CO_OD_GET(type, name) \
+    CO_OD_LOAD(type, OD_##name)
+
+/** Read element _i_ of OD array _name_. */
+#define CO_OD_GET_ARR(type, name, i) \
+    CO_OD_LOAD(type, OD_##name[i])
+
+/** Read _member_ of OD record _name_. */
+#define CO_OD_GET_REC(type, name, member) \
+    CO_OD_LOAD(type, OD_##name.member)
+
+
+/** Write OD variable _name_ and mark OD entry as changed. */
+#define CO_OD_SET(type, SDO, name, value) do{ \
+        CO_OD_STORE(type, OD_##name, value); \
+        CO_OD_markDirty((SDO), ODE_##name); \
+    }while(0)
+
+/** Write element _i_ of OD array _name_ and mark OD entry as changed. */
+#define CO_OD_SET_ARR(type, SDO, name, i, value) do{ \
+        CO_OD_STORE(type, OD_##name[i], value); \
+        CO_OD_markDirty((SDO), ODE_##name); \
+    }while(0)
+
+/** Write _member_ of OD record _name_ and mark OD entry as changed. */
+#define CO_OD_SET_REC(type, SDO, name, member, value) do{ \
+        CO_OD_STORE(type, OD_##name.member, value); \
+        CO_OD_markDirty((SDO), ODE_##name); \
+    }while(0)
+
+
+/**
+ * Read consistent value of OD variable wider than 32 bits (INTEGER64,
+ * UNSIGNED64, REAL64) or of whole record. Copy is repeated, if PDO writes OD
+ * entry _name_ meanwhile. Must not be used from thread, which interrupts PDO
+ * processing.
+ *
+ * @param SDO SDO object, which owns the Object Dictionary.
+ * @param name Name of the OD entry.
+ * @param dest Variable of the same type, where value will be copied.
+ * @param var OD variable (lvalue), OD_name or its member or element.
+ */
+#define CO_OD_LOAD_SEQ(SDO, name, dest, var) do{ \
+        uint16_t CO_OD_seq; \
+        (void)sizeof(char[(sizeof(dest) == sizeof(var)) ? 1 : -1]); \
+        do{ \
+            CO_OD_seq = CO_OD_readBegin((SDO), ODE_##name); \
+            (dest) = (var); \
+        }while(CO_OD_readRetry((SDO), ODE_##name, CO_OD_seq)); \
+    }while(0)
+
+
+/**
+ * Write OD variable wider than 32 bits or whole record, so readers never see
+ * partially written value. OD entry _name_ is marked as changed.
+ *
+ * @param SDO SDO object, which owns the Object Dictionary.
+ * @param name Name of the OD entry.
+ * @param var OD variable (lvalue), OD_name or its member or element.
+ * @param value New value.
+ */
+#define CO_OD_STORE_SEQ(SDO, name, var, value) do{ \
+        CO_OD_writeBegin((SDO), ODE_##name); \
+        (var) = (value); \
+        CO_OD_writeEnd((SDO), ODE_##name); \
+    }while(0)
+
+
+/**
+ * Object dictionary extension of OD entry _name_, without CO_OD_find(), or
+ * NULL. Its pODFunc, object and stream may be used directly.
+ */
+#define CO_OD_EXTENSION(SDO, name) \
+    CO_OD_getExtension((SDO), ODE_##name)
+
+/** Pointer to #CO_SDO_OD_flags_t of OD entry _name_ and sub-index _sub_. */
+#define CO_OD_FLAGS(SDO, name, sub) \
+    CO_OD_getFlagsPointer((SDO), ODE_##name, (sub))
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+/** @} */
+#endif
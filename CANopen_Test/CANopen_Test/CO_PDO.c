@@ -52,6 +52,97 @@
 #include "CO_PDO.h"
 #include <string.h>
 
+/* Mask of lower _bits_ bits of 64 bit word, bits is 1 to 64. */
+#define CO_PDO_BIT_MASK(bits) (0xFFFFFFFFFFFFFFFFULL >> (64 - (bits)))
+
+/* True, if time a is before time b. Times are compared across overflow. */
+#define CO_PDO_TIME_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/* Group of bits in CO_RPDO_t::CANrxState for ready buffer of slot 0 or 1. */
+#define CO_RPDO_SLOT_SHIFT(slot) ((slot) * 3)
+#define CO_RPDO_SLOT_MASK        0x07
+#define CO_RPDO_SLOT_NEW         0x04
+#define CO_RPDO_SLOT_BUFFER      0x03
+
+/* Bytes of multibyte variable are reversed only on big endian targets. */
+#ifdef CO_BIG_ENDIAN
+    #define CO_PDO_RUN_SWAPPED(run) ((run)->swap)
+#else
+    #define CO_PDO_RUN_SWAPPED(run) false
+#endif
+
+/*
+ * Replace bits of CO_RPDO_t::CANrxState atomically.
+ *
+ * CAN receive interrupt and CO_RPDO_process() own one receive buffer each and
+ * exchange it with ready buffer, so data are never copied twice and never torn.
+ *
+ * @param RPDO RPDO object.
+ * @param mask Bits to replace.
+ * @param value New value of bits.
+ *
+ * @return Previous value of CANrxState.
+ */
+static uint8_t CO_RPDOexchange(CO_RPDO_t *RPDO, uint8_t mask, uint8_t value){
+    uint8_t state;
+
+    do{
+        state = RPDO->CANrxState;
+    }while(!CO_atomicCAS8(&RPDO->CANrxState, state, (state & ~mask) | value));
+
+    return state;
+}
+
+
+/*
+ * Discard unprocessed messages of RPDO.
+ */
+static inline void CO_RPDOdiscard(CO_RPDO_t *RPDO, uint8_t slots){
+    uint8_t mask = 0;
+
+    if(slots & 0x01) mask |= CO_RPDO_SLOT_NEW << CO_RPDO_SLOT_SHIFT(0);
+    if(slots & 0x02) mask |= CO_RPDO_SLOT_NEW << CO_RPDO_SLOT_SHIFT(1);
+    CO_RPDOexchange(RPDO, mask, 0);
+}
+
+
+#if CO_CONFIG_MPDO
+/*
+ * Queue received MPDO.
+ *
+ * MPDO in destination address mode is queued only, if it is addressed to this
+ * node or to all nodes. Queue has single producer (CAN receive interrupt) and
+ * single consumer (CO_RPDO_process()), so no lock is needed.
+ *
+ * @return True, if MPDO was queued.
+ */
+static bool_t CO_RPDOreceiveMPDO(CO_RPDO_t *RPDO, const CO_CANrxMsg_t *msg){
+    uint8_t head = RPDO->MPDOhead;
+    uint8_t next = (head + 1) & (CO_MPDO_QUEUE_SIZE - 1);
+    uint8_t address = msg->data[0];
+
+    if(RPDO->map->MPDO == CO_PDO_MPDO_DAM){
+        if((address & 0x80) == 0) return false;
+        address &= 0x7F;
+        if(address != 0 && address != RPDO->nodeId) return false;
+    }
+    else if((address & 0x80) != 0){
+        return false;
+    }
+
+    if(next == RPDO->MPDOtail){
+        RPDO->MPDOoverflow = true;
+        return false;
+    }
+    memcpy((void*)&RPDO->MPDOqueue[head][0], (const void*)&msg->data[0], 8);
+    CO_MEMORY_BARRIER();
+    RPDO->MPDOhead = next;
+
+    return true;
+}
+#endif
+
+
 /*
  * Read received message from CAN module.
  *
@@ -68,46 +159,123 @@ static void CO_PDO_receive(void *object, const CO_CANrxMsg_t *msg){
 
     if( (RPDO->valid) &&
         (*RPDO->operatingState == CO_NMT_OPERATIONAL) &&
-        (msg->DLC >= RPDO->dataLength))
+        (msg->DLC >= RPDO->map->dataLength))
     {
-        if(RPDO->synchronous && RPDO->SYNC->CANrxToggle) {
-            /* copy data into second buffer and set 'new message' flag */
-            RPDO->CANrxData[1][0] = msg->data[0];
-            RPDO->CANrxData[1][1] = msg->data[1];
-            RPDO->CANrxData[1][2] = msg->data[2];
-            RPDO->CANrxData[1][3] = msg->data[3];
-            RPDO->CANrxData[1][4] = msg->data[4];
-            RPDO->CANrxData[1][5] = msg->data[5];
-            RPDO->CANrxData[1][6] = msg->data[6];
-            RPDO->CANrxData[1][7] = msg->data[7];
-
-            RPDO->CANrxNew[1] = true;
+        uint8_t *data = &RPDO->CANrxData[RPDO->CANrxWrite][0];
+        uint8_t shift;
+        uint8_t state;
+
+#if CO_CONFIG_MPDO
+        /* each MPDO carries different object, all of them are queued */
+        if(RPDO->map->MPDO != 0){
+            if(CO_RPDOreceiveMPDO(RPDO, msg) && !RPDO->synchronous && RPDO->pFunctSignal != NULL){
+                RPDO->pFunctSignal();
+            }
+            return;
         }
-        else {
-            /* copy data into default buffer and set 'new message' flag */
-            RPDO->CANrxData[0][0] = msg->data[0];
-            RPDO->CANrxData[0][1] = msg->data[1];
-            RPDO->CANrxData[0][2] = msg->data[2];
-            RPDO->CANrxData[0][3] = msg->data[3];
-            RPDO->CANrxData[0][4] = msg->data[4];
-            RPDO->CANrxData[0][5] = msg->data[5];
-            RPDO->CANrxData[0][6] = msg->data[6];
-            RPDO->CANrxData[0][7] = msg->data[7];
-
-            RPDO->CANrxNew[0] = true;
+#endif
+
+        shift = CO_RPDO_SLOT_SHIFT((RPDO->synchronous && RPDO->SYNC->CANrxToggle) ? 1 : 0);
+
+        /* copy data into own buffer */
+        data[0] = msg->data[0];
+        data[1] = msg->data[1];
+        data[2] = msg->data[2];
+        data[3] = msg->data[3];
+        data[4] = msg->data[4];
+        data[5] = msg->data[5];
+        data[6] = msg->data[6];
+        data[7] = msg->data[7];
+        CO_MEMORY_BARRIER();
+
+        /* publish it as ready with 'new message' flag and take previous ready buffer */
+        state = CO_RPDOexchange(RPDO, CO_RPDO_SLOT_MASK << shift,
+                                (RPDO->CANrxWrite | CO_RPDO_SLOT_NEW) << shift);
+        RPDO->CANrxWrite = (state >> shift) & CO_RPDO_SLOT_BUFFER;
+
+        /* Optional signal to RTOS, which can resume task, which handles RPDO. */
+        if(!RPDO->synchronous && RPDO->pFunctSignal != NULL) {
+            RPDO->pFunctSignal();
         }
     }
 }
 
 
+/*
+ * Link RPDO into the list of valid PDOs according to its state.
+ *
+ * Function is called, when _valid_ or _synchronous_ changes. RPDO is removed
+ * from its previous list and inserted at the head of the new one.
+ */
+static void CO_RPDOupdateActive(CO_RPDO_t *RPDO){
+    CO_RPDO_t **list = NULL;
+
+    if(RPDO->valid){
+        list = RPDO->synchronous ? &RPDO->lists->RPDOsync : &RPDO->lists->RPDOasync;
+    }
+    if(list == RPDO->activeList) return;
+
+    CO_LOCK_PDO();
+    if(RPDO->activeList != NULL){
+        if(RPDO->activePrev != NULL) RPDO->activePrev->activeNext = RPDO->activeNext;
+        else                         *RPDO->activeList = RPDO->activeNext;
+        if(RPDO->activeNext != NULL) RPDO->activeNext->activePrev = RPDO->activePrev;
+    }
+    RPDO->activeList = list;
+    RPDO->activePrev = NULL;
+    RPDO->activeNext = NULL;
+    if(list != NULL){
+        RPDO->activeNext = *list;
+        if(*list != NULL) (*list)->activePrev = RPDO;
+        *list = RPDO;
+    }
+    CO_UNLOCK_PDO();
+}
+
+
+/*
+ * Link TPDO into the list of valid PDOs according to its state.
+ *
+ * Function is called, when _valid_ or _eventDriven_ changes. TPDO is removed
+ * from its previous list and inserted at the head of the new one.
+ */
+static void CO_TPDOupdateActive(CO_TPDO_t *TPDO){
+    CO_TPDO_t **list = NULL;
+
+    if(TPDO->valid){
+        list = TPDO->eventDriven ? &TPDO->lists->TPDOasync : &TPDO->lists->TPDOsync;
+    }
+    if(list == TPDO->activeList) return;
+
+    CO_LOCK_PDO();
+    if(TPDO->activeList != NULL){
+        if(TPDO->activePrev != NULL) TPDO->activePrev->activeNext = TPDO->activeNext;
+        else                         *TPDO->activeList = TPDO->activeNext;
+        if(TPDO->activeNext != NULL) TPDO->activeNext->activePrev = TPDO->activePrev;
+    }
+    TPDO->activeList = list;
+    TPDO->activePrev = NULL;
+    TPDO->activeNext = NULL;
+    if(list != NULL){
+        TPDO->activeNext = *list;
+        if(*list != NULL) (*list)->activePrev = TPDO;
+        *list = TPDO;
+    }
+    /* synchronous TPDO is not processed while it is not in the list */
+    if(!TPDO->valid && !TPDO->eventDriven) TPDO->sendRequest = 0;
+    CO_UNLOCK_PDO();
+}
+
+
 /*
  * Configure RPDO Communication parameter.
  *
  * Function is called from commuincation reset or when parameter changes.
  *
  * Function configures following variable from CO_RPDO_t: _valid_. It also
- * configures CAN rx buffer. If configuration fails, emergency message is send
- * and device is not able to enter NMT operational.
+ * configures CAN rx buffer and links RPDO into the list of valid PDOs. If
+ * configuration fails, emergency message is send and device is not able to
+ * enter NMT operational.
  *
  * @param RPDO RPDO object.
  * @param COB_IDUsedByRPDO _RPDO communication parameter_, _COB-ID for PDO_ variable
@@ -120,7 +288,7 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
     ID = (uint16_t)COB_IDUsedByRPDO;
 
     /* is RPDO used? */
-    if((COB_IDUsedByRPDO & 0xBFFFF800L) == 0 && RPDO->dataLength && ID){
+    if((COB_IDUsedByRPDO & 0xBFFFF800L) == 0 && RPDO->map->dataLength && ID){
         /* is used default COB-ID? */
         if(ID == RPDO->defaultCOB_ID) ID += RPDO->nodeId;
         RPDO->valid = true;
@@ -129,7 +297,7 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
     else{
         ID = 0;
         RPDO->valid = false;
-        RPDO->CANrxNew[0] = RPDO->CANrxNew[1] = false;
+        CO_RPDOdiscard(RPDO, 0x03);
     }
     r = CO_CANrxBufferInit(
             RPDO->CANdevRx,         /* CAN device */
@@ -141,8 +309,9 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
             CO_PDO_receive);        /* this function will process received message */
     if(r != CO_ERROR_NO){
         RPDO->valid = false;
-        RPDO->CANrxNew[0] = RPDO->CANrxNew[1] = false;
+        CO_RPDOdiscard(RPDO, 0x03);
     }
+    CO_RPDOupdateActive(RPDO);
 }
 
 
@@ -152,8 +321,9 @@ static void CO_RPDOconfigCom(CO_RPDO_t* RPDO, uint32_t COB_IDUsedByRPDO){
  * Function is called from commuincation reset or when parameter changes.
  *
  * Function configures following variable from CO_TPDO_t: _valid_. It also
- * configures CAN tx buffer. If configuration fails, emergency message is send
- * and device is not able to enter NMT operational.
+ * configures CAN tx buffer and links TPDO into the list of valid PDOs. If
+ * configuration fails, emergency message is send and device is not able to
+ * enter NMT operational.
  *
  * @param TPDO TPDO object.
  * @param COB_IDUsedByTPDO _TPDO communication parameter_, _COB-ID for PDO_ variable
@@ -166,7 +336,7 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
     ID = (uint16_t)COB_IDUsedByTPDO;
 
     /* is TPDO used? */
-    if((COB_IDUsedByTPDO & 0xBFFFF800L) == 0 && TPDO->dataLength && ID){
+    if((COB_IDUsedByTPDO & 0xBFFFF800L) == 0 && TPDO->map->dataLength && ID){
         /* is used default COB-ID? */
         if(ID == TPDO->defaultCOB_ID) ID += TPDO->nodeId;
         TPDO->valid = true;
@@ -181,12 +351,13 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
             TPDO->CANdevTxIdx,         /* index of specific buffer inside CAN module */
             ID,                        /* CAN identifier */
             0,                         /* rtr */
-            TPDO->dataLength,          /* number of data bytes */
+            TPDO->map->dataLength,     /* number of data bytes */
             syncFlag);                 /* synchronous message flag bit */
 
     if(TPDO->CANtxBuff == 0){
         TPDO->valid = false;
     }
+    CO_TPDOupdateActive(TPDO);
 }
 
 
@@ -199,9 +370,15 @@ static void CO_TPDOconfigCom(CO_TPDO_t* TPDO, uint32_t COB_IDUsedByTPDO, uint8_t
  * @param map PDO mapping parameter.
  * @param R_T 0 for RPDO map, 1 for TPDO map.
  * @param ppData Pointer to returning parameter: pointer to data of mapped variable.
- * @param pLength Pointer to returning parameter: *add* length of mapped variable.
+ * @param pLength Pointer to returning parameter: *add* length of mapped
+ * variable in bits.
  * @param pSendIfCOSFlags Pointer to returning parameter: sendIfCOSFlags variable.
- * @param pIsMultibyteVar Pointer to returning parameter: true for multibyte variable.
+ * @param pAttribute Pointer to returning parameter: attribute of mapped
+ * variable, 0 for dummy entries.
+ * @param pObjectLen Pointer to returning parameter: length of mapped variable
+ * in bytes, at most 8.
+ * @param pEntryNo Pointer to returning parameter: sequence number of OD entry,
+ * 0xFFFF for dummy entries.
  *
  * @return 0 on success, otherwise SDO abort code.
  */
@@ -211,38 +388,38 @@ static uint32_t CO_PDOfindMap(
         uint8_t                 R_T,
         uint8_t               **ppData,
         uint8_t                *pLength,
-        uint8_t                *pSendIfCOSFlags,
-        uint8_t                *pIsMultibyteVar)
+        uint64_t               *pSendIfCOSFlags,
+        uint16_t               *pAttribute,
+        uint8_t                *pObjectLen,
+        uint16_t               *pEntryNo)
 {
     uint16_t entryNo;
     uint16_t index;
     uint8_t subIndex;
     uint8_t dataLen;
     uint8_t objectLen;
-    uint8_t attr;
+    uint16_t attr;
+    CO_OD_descriptor_t desc;
 
     index = (uint16_t)(map>>16);
     subIndex = (uint8_t)(map>>8);
     dataLen = (uint8_t) map;   /* data length in bits */
 
-    /* data length must be byte aligned */
-    if(dataLen&0x07) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
-
-    dataLen >>= 3;    /* new data length is in bytes */
+    /* total PDO length can not be more than 64 bits */
+    if(dataLen > 64 || (*pLength + dataLen) > 64) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
     *pLength += dataLen;
 
-    /* total PDO length can not be more than 8 bytes */
-    if(*pLength > 8) return CO_SDO_AB_MAP_LEN;  /* The number and length of the objects to be mapped would exceed PDO length. */
-
     /* is there a reference to dummy entries */
+    *pEntryNo = 0xFFFF;
     if(index <=7 && subIndex == 0){
         static uint32_t dummyTX = 0;
         static uint32_t dummyRX;
-        uint8_t dummySize = 4;
+        uint8_t dummySize = 32;
 
-        if(index<2) dummySize = 0;
-        else if(index==2 || index==5) dummySize = 1;
-        else if(index==3 || index==6) dummySize = 2;
+        if(index==0) dummySize = 0;
+        else if(index==1) dummySize = 1;
+        else if(index==2 || index==5) dummySize = 8;
+        else if(index==3 || index==6) dummySize = 16;
 
         /* is size of variable big enough for map */
         if(dummySize < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
@@ -250,184 +427,1097 @@ static uint32_t CO_PDOfindMap(
         /* Data and ODE pointer */
         if(R_T == 0) *ppData = (uint8_t*) &dummyRX;
         else         *ppData = (uint8_t*) &dummyTX;
+        *pAttribute = 0;
+        *pObjectLen = sizeof(dummyRX);
 
         return 0;
     }
 
     /* find object in Object Dictionary */
     entryNo = CO_OD_find(SDO, index);
+    *pEntryNo = entryNo;
 
     /* Does object exist in OD? */
     if(entryNo == 0xFFFF || subIndex > SDO->OD[entryNo].maxSubIndex)
         return CO_SDO_AB_NOT_EXIST;   /* Object does not exist in the object dictionary. */
 
-    attr = CO_OD_getAttribute(SDO, entryNo, subIndex);
+    CO_OD_getDescriptor(SDO, entryNo, subIndex, &desc);
+    attr = desc.attribute;
     /* Is object Mappable for RPDO? */
     if(R_T==0 && !((attr&CO_ODA_RPDO_MAPABLE) && (attr&CO_ODA_WRITEABLE))) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
     /* Is object Mappable for TPDO? */
     if(R_T!=0 && !((attr&CO_ODA_TPDO_MAPABLE) && (attr&CO_ODA_READABLE))) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
 
     /* is size of variable big enough for map */
-    objectLen = CO_OD_getLength(SDO, entryNo, subIndex);
-    if(objectLen < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    if(((uint32_t)desc.length * 8) < dataLen) return CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+    objectLen = (desc.length > 8) ? 8 : (uint8_t)desc.length;
 
-    /* mark multibyte variable */
-    *pIsMultibyteVar = (attr&CO_ODA_MB_VALUE) ? 1 : 0;
+    /* pointer to data, attribute and length */
+    *ppData = (uint8_t*) desc.pData;
+    *pAttribute = attr;
+    *pObjectLen = objectLen;
+
+    /* setup change of state flags, one for each bit of mapped variable */
+    if((attr&CO_ODA_TPDO_DETECT_COS) && dataLen){
+        *pSendIfCOSFlags |= (CO_PDO_BIT_MASK(dataLen)) << (*pLength - dataLen);
+    }
+
+    return 0;
+}
+
+
+/*
+ * Add OD entry to the list of OD entries mapped to PDO, if not already there.
+ *
+ * @param ODentryNo List of OD entries.
+ * @param pNoOfODentries Pointer to number of OD entries in the list.
+ * @param entryNo Sequence number of OD entry, 0xFFFF for dummy entries.
+ */
+static void CO_PDOaddODentry(uint16_t ODentryNo[], uint8_t *pNoOfODentries, uint16_t entryNo){
+    uint8_t i;
+
+    if(entryNo == 0xFFFF) return;
+
+    for(i=0; i<*pNoOfODentries; i++){
+        if(ODentryNo[i] == entryNo) return;
+    }
+    ODentryNo[(*pNoOfODentries)++] = entryNo;
+}
 
-    /* pointer to data */
-    *ppData = (uint8_t*) CO_OD_getDataPointer(SDO, entryNo, subIndex);
+
+/*
+ * Add mapped object to the PDO copy plan.
+ *
+ * Byte aligned object, which follows previous byte run in PDO data and in
+ * memory, extends previous run, otherwise new run is added. Object, which is
+ * not byte aligned in PDO data or its length is not multiple of 8 bits, gets
+ * own bit run with precomputed mask. Multibyte variable, which is mapped with
+ * shorter length, gets bit run too. Bit run accesses whole multibyte
+ * variable, so received value is zero or sign extended.
+ *
+ * @param copyPlan Copy plan.
+ * @param pNoOfCopies Pointer to number of runs in the copy plan.
+ * @param pData Pointer to data of mapped variable.
+ * @param objectLen Length of mapped variable in bytes.
+ * @param attribute Attribute of mapped variable.
+ * @param offset Offset of mapped variable in PDO data in bits.
+ * @param length Length of mapped variable in PDO data in bits.
+ */
+static void CO_PDOaddCopy(
+        CO_PDOcopy_t            copyPlan[],
+        uint8_t                *pNoOfCopies,
+        uint8_t                *pData,
+        uint8_t                 objectLen,
+        uint16_t                attribute,
+        uint8_t                 offset,
+        uint8_t                 length)
+{
+    CO_PDOcopy_t *run;
+    bool_t MBvar = (attribute & CO_ODA_MB_VALUE) ? true : false;
+    bool_t swap = false;
+    uint64_t mask = 0;
+    uint8_t size = (length + 7) >> 3;
+
+    if(length == 0) return;
+
+    if(((offset | length) & 0x07) != 0 || (MBvar && size < objectLen)){
+        mask = CO_PDO_BIT_MASK(length) << offset;
+        if(MBvar) size = objectLen;
+#ifdef CO_BIG_ENDIAN
+        swap = MBvar;
+#endif
+    }
 #ifdef CO_BIG_ENDIAN
-    /* skip unused MSB bytes */
-    if(*pIsMultibyteVar){
-        *ppData += objectLen - dataLen;
+    else if(MBvar){
+        /* skip unused MSB bytes */
+        pData += objectLen - size;
+        if(length > 8) swap = true;
     }
 #endif
 
-    /* setup change of state flags */
-    if(attr&CO_ODA_TPDO_DETECT_COS){
-        int16_t i;
-        for(i=*pLength-dataLen; i<*pLength; i++){
-            *pSendIfCOSFlags |= 1<<i;
+    /* merge byte run with previous byte run */
+    else if(*pNoOfCopies > 0 && !swap){
+        run = &copyPlan[*pNoOfCopies - 1];
+        if(run->mask == 0 && (run->offset + run->length) == offset
+                && (run->pData + (run->length >> 3)) == pData
+                && !CO_PDO_RUN_SWAPPED(run)){
+            run->length += length;
+            return;
         }
     }
 
-    return 0;
+    run = &copyPlan[(*pNoOfCopies)++];
+    run->mask = mask;
+    run->pData = pData;
+    run->offset = offset;
+    run->length = length;
+    run->size = size;
+    run->isSigned = (attribute & CO_ODA_SIGNED) ? true : false;
+#ifdef CO_BIG_ENDIAN
+    run->swap = swap;
+#endif
+}
+
+
+/*
+ * Copy one byte run of PDO copy plan.
+ *
+ * Lengths of usual variables are constant for the compiler, so they are
+ * copied with single load and store.
+ */
+static inline void CO_PDOcopyRun(uint8_t *dest, const uint8_t *src, uint8_t length){
+    switch(length){
+        case 1: *dest = *src; break;
+        case 2: memcpy((void*)dest, (const void*)src, 2); break;
+        case 4: memcpy((void*)dest, (const void*)src, 4); break;
+        case 8: memcpy((void*)dest, (const void*)src, 8); break;
+        default: memcpy((void*)dest, (const void*)src, length); break;
+    }
+}
+
+
+/*
+ * Read PDO data or mapped variable of bit run as little endian value.
+ *
+ * @param pData Pointer to data.
+ * @param size Number of bytes, 1 to 8.
+ * @param swap True, if bytes are in big endian order.
+ */
+static inline uint64_t CO_PDOgetBits(const uint8_t *pData, uint8_t size, bool_t swap){
+    uint64_t value = 0;
+    uint8_t i;
+
+    for(i=0; i<size; i++){
+        value |= ((uint64_t) pData[swap ? (size - 1 - i) : i]) << (i * 8);
+    }
+    return value;
+}
+
+
+/*
+ * Write little endian value to PDO data or mapped variable of bit run.
+ *
+ * @param pData Pointer to data.
+ * @param size Number of bytes, 1 to 8.
+ * @param swap True, if bytes are in big endian order.
+ * @param value Value to write.
+ */
+static inline void CO_PDOsetBits(uint8_t *pData, uint8_t size, bool_t swap, uint64_t value){
+    uint8_t i;
+
+    for(i=0; i<size; i++){
+        pData[swap ? (size - 1 - i) : i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+
+/*
+ * Copy mapped OD variables to PDO data by copy plan.
+ *
+ * Byte runs are copied directly. Bit runs are shifted and masked into one 64
+ * bit word, which is then merged with PDO data.
+ */
+static void CO_PDOpack(uint8_t *PDOdata, const CO_PDOcopy_t copyPlan[], uint8_t noOfCopies){
+    const CO_PDOcopy_t *run = &copyPlan[0];
+    uint64_t bits = 0;
+    uint64_t bitsMask = 0;
+
+    for(; noOfCopies>0; noOfCopies--, run++){
+        if(run->mask != 0){
+            uint64_t value = CO_PDOgetBits(run->pData, run->size, CO_PDO_RUN_SWAPPED(run));
+            bits |= (value << run->offset) & run->mask;
+            bitsMask |= run->mask;
+            continue;
+        }
+#ifdef CO_BIG_ENDIAN
+        if(run->swap){
+            uint8_t i;
+            uint8_t size = run->length >> 3;
+            for(i=0; i<size; i++)
+                PDOdata[(run->offset >> 3) + i] = run->pData[size - 1 - i];
+            continue;
+        }
+#endif
+        CO_PDOcopyRun(&PDOdata[run->offset >> 3], run->pData, run->length >> 3);
+    }
+
+    if(bitsMask != 0){
+        uint64_t word = CO_PDOgetBits(PDOdata, 8, false);
+        CO_PDOsetBits(PDOdata, 8, false, (word & ~bitsMask) | bits);
+    }
+}
+
+
+/*
+ * Copy PDO data to mapped OD variables by copy plan.
+ *
+ * For bit runs mapped variable gets value of mapped bits, zero extended or
+ * sign extended for signed integer variable.
+ */
+static void CO_PDOunpack(const uint8_t *PDOdata, const CO_PDOcopy_t copyPlan[], uint8_t noOfCopies){
+    const CO_PDOcopy_t *run = &copyPlan[0];
+    uint64_t word = 0;
+    uint64_t value;
+    bool_t wordValid = false;
+
+    for(; noOfCopies>0; noOfCopies--, run++){
+        if(run->mask != 0){
+            if(!wordValid){
+                word = CO_PDOgetBits(PDOdata, 8, false);
+                wordValid = true;
+            }
+            value = (word & run->mask) >> run->offset;
+            if(run->isSigned && (value & (1ULL << (run->length - 1)))){
+                value |= ~CO_PDO_BIT_MASK(run->length);
+            }
+            CO_PDOsetBits(run->pData, run->size, CO_PDO_RUN_SWAPPED(run), value);
+            continue;
+        }
+#ifdef CO_BIG_ENDIAN
+        if(run->swap){
+            uint8_t i;
+            uint8_t size = run->length >> 3;
+            for(i=0; i<size; i++)
+                run->pData[size - 1 - i] = PDOdata[(run->offset >> 3) + i];
+            continue;
+        }
+#endif
+        CO_PDOcopyRun(run->pData, &PDOdata[run->offset >> 3], run->length >> 3);
+    }
+}
+
+
+#if defined(RPDO_CALLS_EXTENSION) || defined(TPDO_CALLS_EXTENSION)
+/*
+ * Resolve OD extensions of mapped objects.
+ *
+ * Function is called when PDO mapping is configured and again, if new OD
+ * extension was added since then. Only mapped objects with extension are
+ * stored, dummy entries and objects without extension are skipped.
+ *
+ * @param SDO SDO object.
+ * @param pMap Pointer to the first mapped object in PDO mapping parameter.
+ * @param noOfMappedObjects Number of mapped objects.
+ * @param extensions Returning array of 8 mapped objects with extension.
+ *
+ * @return Number of elements in extensions.
+ */
+static uint8_t CO_PDOresolveExtensions(
+        CO_SDO_t               *SDO,
+        const uint32_t         *pMap,
+        uint8_t                 noOfMappedObjects,
+        CO_PDOextension_t       extensions[])
+{
+    uint8_t noOfExtensions = 0;
+
+    if(SDO->ODExtensions == NULL) return 0;
+
+    for(; noOfMappedObjects>0 && noOfExtensions<8; noOfMappedObjects--){
+        uint32_t map = *(pMap++);
+        uint16_t index = (uint16_t)(map>>16);
+        uint8_t subIndex = (uint8_t)(map>>8);
+        uint16_t entryNo;
+        CO_OD_extension_t *ext;
+        CO_OD_descriptor_t desc;
+
+        if(index <= 7) continue;
+        entryNo = CO_OD_find(SDO, index);
+        if(entryNo == 0xFFFF) continue;
+        ext = CO_OD_getExtension(SDO, entryNo);
+        if(ext == NULL) continue;
+
+        CO_OD_getDescriptor(SDO, entryNo, subIndex, &desc);
+        extensions[noOfExtensions].ext = ext;
+        extensions[noOfExtensions].pData = desc.pData;
+        extensions[noOfExtensions].dataLength = desc.length;
+        extensions[noOfExtensions].attribute = desc.attribute;
+        extensions[noOfExtensions].index = index;
+        extensions[noOfExtensions].subIndex = subIndex;
+        noOfExtensions++;
+    }
+
+    return noOfExtensions;
+}
+
+
+/*
+ * Call @ref CO_SDO_OD_function of mapped objects with OD extension.
+ *
+ * Function is called after RPDO data are written to or before TPDO data are
+ * read from Object Dictionary. Data are accessed in place, in one segment.
+ *
+ * @param extensions Mapped objects with extension.
+ * @param noOfExtensions Number of elements in extensions.
+ * @param reading True for TPDO, false for RPDO.
+ */
+static void CO_PDOcallExtensions(
+        const CO_PDOextension_t extensions[],
+        uint8_t                 noOfExtensions,
+        bool_t                  reading)
+{
+    CO_ODF_arg_t ODF_arg;
+    uint8_t i;
+
+    for(i=0; i<noOfExtensions; i++){
+        const CO_PDOextension_t *e = &extensions[i];
+        CO_OD_extension_t *ext = e->ext;
+
+        /* function may be configured or removed later */
+        if(ext->pODFunc == NULL) continue;
+
+        ODF_arg.object = ext->object;
+        ODF_arg.data = (uint8_t*)e->pData;
+        ODF_arg.ODdataStorage = e->pData;
+        ODF_arg.dataLength = e->dataLength;
+        ODF_arg.attribute = e->attribute;
+        ODF_arg.pFlags = (ext->flags != NULL) ? &ext->flags[e->subIndex] : NULL;
+        ODF_arg.index = e->index;
+        ODF_arg.subIndex = e->subIndex;
+        ODF_arg.reading = reading;
+        ODF_arg.firstSegment = true;
+        ODF_arg.lastSegment = true;
+        ODF_arg.dataLengthTotal = 0;
+        ODF_arg.offset = 0;
+        ext->pODFunc(&ODF_arg);
+    }
+}
+
+
+#if CO_CONFIG_MPDO
+/*
+ * Call @ref CO_SDO_OD_function of MPDO object.
+ *
+ * @param ext OD extension of object's OD entry or NULL.
+ * @param desc Descriptor of object.
+ * @param index Index of object.
+ * @param subIndex Sub-index of object.
+ * @param reading True for TPDO, false for RPDO.
+ */
+static void CO_PDOcallExtensionMPDO(
+        CO_OD_extension_t      *ext,
+        const CO_OD_descriptor_t *desc,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        bool_t                  reading)
+{
+    CO_PDOextension_t extension;
+
+    if(ext == NULL) return;
+
+    extension.ext = ext;
+    extension.pData = desc->pData;
+    extension.dataLength = desc->length;
+    extension.attribute = desc->attribute;
+    extension.index = index;
+    extension.subIndex = subIndex;
+    CO_PDOcallExtensions(&extension, 1, reading);
+}
+#endif
+#endif
+
+
+#if CO_CONFIG_MPDO
+/*
+ * Copy data of MPDO object between MPDO and OD variable.
+ *
+ * MPDO data are little endian, bytes of multibyte variable are reversed only
+ * on big endian targets.
+ */
+static inline void CO_PDOcopyMPDO(uint8_t *dest, const uint8_t *src, uint8_t length, uint16_t attribute){
+#ifdef CO_BIG_ENDIAN
+    if(attribute & CO_ODA_MB_VALUE){
+        uint8_t i;
+
+        for(i=0; i<length; i++) dest[i] = src[length - 1 - i];
+        return;
+    }
+#else
+    (void)attribute;
+#endif
+    memcpy((void*)dest, (const void*)src, length);
+}
+
+
+/*
+ * Find object of MPDO in Object Dictionary.
+ *
+ * Object must be mappable to RPDO and writeable (R_T = 0) or mappable to TPDO
+ * and readable (R_T = 1) and not longer than 4 bytes.
+ *
+ * @param SDO SDO object.
+ * @param index Index of object.
+ * @param subIndex Sub-index of object.
+ * @param R_T 0 for RPDO, 1 for TPDO.
+ * @param desc Returning descriptor of object.
+ *
+ * @return Sequence number of OD entry or 0xFFFF, if object can not be used.
+ */
+static uint16_t CO_PDOfindMPDO(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        uint8_t                 subIndex,
+        uint8_t                 R_T,
+        CO_OD_descriptor_t     *desc)
+{
+    uint16_t entryNo = CO_OD_find(SDO, index);
+    uint16_t attrMask = (R_T == 0) ? (CO_ODA_RPDO_MAPABLE | CO_ODA_WRITEABLE)
+                                   : (CO_ODA_TPDO_MAPABLE | CO_ODA_READABLE);
+
+    if(entryNo == 0xFFFF || subIndex > SDO->OD[entryNo].maxSubIndex) return 0xFFFF;
+
+    CO_OD_getDescriptor(SDO, entryNo, subIndex, desc);
+    if((desc->attribute & attrMask) != attrMask || desc->length > 4 || desc->pData == NULL) return 0xFFFF;
+
+    return entryNo;
+}
+
+
+/*
+ * Translate object of received SAM MPDO by object dispatcher list.
+ *
+ * @param RPDO RPDO object.
+ * @param nodeId Node-ID of MPDO producer.
+ * @param index Producer's index of object.
+ * @param pSubIndex Pointer to sub-index, producer's on call, local on return.
+ *
+ * @return Dispatcher list entry with local object or NULL, if not found.
+ */
+static CO_MPDOdispatcherEntry_t *CO_RPDOdispatchMPDO(const CO_RPDO_t *RPDO, uint8_t nodeId, uint16_t index, uint8_t *pSubIndex){
+    uint8_t i;
+
+    for(i=0; i<RPDO->MPDOnoOfDispatcherEntries; i++){
+        uint64_t entry = RPDO->MPDOdispatcher[i].object;
+        uint8_t subIndex = (uint8_t)entry;
+        uint8_t blockSize = (uint8_t)(entry >> 56);
+
+        if(blockSize == 0) blockSize = 1;
+        if((uint8_t)(entry >> 24) == nodeId && (uint16_t)(entry >> 8) == index
+                && *pSubIndex >= subIndex && (*pSubIndex - subIndex) < blockSize){
+            *pSubIndex = (uint8_t)(entry >> 32) + (*pSubIndex - subIndex);
+            return &RPDO->MPDOdispatcher[i];
+        }
+    }
+
+    return NULL;
 }
 
 
+/*
+ * Write received MPDOs to Object Dictionary.
+ *
+ * Function is called from CO_RPDO_process(). Objects, which are not in
+ * dispatcher list or can not be written, are ignored. OD entries of SAM
+ * objects were resolved by CO_RPDO_initMPDO(), DAM object is searched.
+ */
+static void CO_RPDOprocessMPDO(CO_RPDO_t *RPDO){
+    uint8_t tail = RPDO->MPDOtail;
+
+    while(tail != RPDO->MPDOhead){
+        const uint8_t *data = &RPDO->MPDOqueue[tail][0];
+        uint16_t index = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+        uint8_t subIndex = data[3];
+        uint16_t entryNo;
+        CO_OD_descriptor_t desc;
+#ifdef RPDO_CALLS_EXTENSION
+        CO_OD_extension_t *ext = NULL;
+#endif
+
+        CO_MEMORY_BARRIER();
+        if(RPDO->map->MPDO == CO_PDO_MPDO_SAM){
+            CO_MPDOdispatcherEntry_t *dispatch = CO_RPDOdispatchMPDO(RPDO, data[0] & 0x7F, index, &subIndex);
+
+            entryNo = 0xFFFF;
+            if(dispatch != NULL){
+                entryNo = dispatch->entryNo;
+                index = (uint16_t)(dispatch->object >> 40);
+                CO_OD_getDescriptor(RPDO->SDO, entryNo, subIndex, &desc);
+#ifdef RPDO_CALLS_EXTENSION
+                /* OD extension was added after list was configured */
+                if(dispatch->extensionsUsed != RPDO->SDO->ODExtensionsUsed){
+                    dispatch->ext = CO_OD_getExtension(RPDO->SDO, entryNo);
+                    dispatch->extensionsUsed = RPDO->SDO->ODExtensionsUsed;
+                }
+                ext = dispatch->ext;
+#endif
+            }
+        }
+        else{
+            entryNo = CO_PDOfindMPDO(RPDO->SDO, index, subIndex, 0, &desc);
+#ifdef RPDO_CALLS_EXTENSION
+            if(entryNo != 0xFFFF) ext = CO_OD_getExtension(RPDO->SDO, entryNo);
+#endif
+        }
+
+        if(entryNo != 0xFFFF){
+            CO_OD_writeBegin(RPDO->SDO, entryNo);
+            CO_PDOcopyMPDO((uint8_t*)desc.pData, &data[4], (uint8_t)desc.length, desc.attribute);
+            CO_OD_writeEnd(RPDO->SDO, entryNo);
+#ifdef RPDO_CALLS_EXTENSION
+            CO_PDOcallExtensionMPDO(ext, &desc, index, subIndex, false);
+#endif
+        }
+
+        tail = (tail + 1) & (CO_MPDO_QUEUE_SIZE - 1);
+        RPDO->MPDOtail = tail;
+    }
+
+    if(RPDO->MPDOoverflow){
+        RPDO->MPDOoverflow = false;
+        CO_errorReport(RPDO->em, CO_EM_RPDO_OVERFLOW, CO_EMC_COMMUNICATION, RPDO->RPDOCommPar->COB_IDUsedByRPDO);
+    }
+}
+
+
+/*
+ * Send MPDO with the next object of scanner list or with mapped object.
+ *
+ * Function is called from CO_TPDOsend(). Scanner list advances only, if
+ * object was sent. Event driven SAM producer requests next sending until the
+ * end of the list.
+ *
+ * @return Same as CO_CANsend(), CO_ERROR_TX_UNCONFIGURED if there is nothing
+ * to send or CO_ERROR_TX_BUSY, if object was just being written.
+ */
+static int16_t CO_TPDOsendMPDO(CO_TPDO_t *TPDO, CO_TPDOmap_t *map){
+    uint8_t data[8] = {0};
+    uint16_t index;
+    uint8_t subIndex;
+    uint8_t blockSize = 1;
+    uint8_t length;
+    uint16_t entryNo;
+    uint16_t seq;
+    CO_OD_descriptor_t desc;
+    int16_t ret;
+
+    /* objects were verified and their OD entries resolved by mapping or by
+     * CO_TPDO_initMPDO() */
+    if(map->MPDO == CO_PDO_MPDO_DAM){
+        if(map->noOfODentries == 0) return CO_ERROR_TX_UNCONFIGURED;
+        index = (uint16_t)(map->MPDOobject >> 16);
+        subIndex = (uint8_t)(map->MPDOobject >> 8);
+        entryNo = map->ODentryNo[0];
+        data[0] = 0x80 | TPDO->MPDOdestination;
+        CO_OD_getDescriptor(TPDO->SDO, entryNo, subIndex, &desc);
+#ifdef TPDO_CALLS_EXTENSION
+        /* OD extension was added after mapping was configured */
+        if(map->extensionsUsed != TPDO->SDO->ODExtensionsUsed){
+            map->noOfExtensions = CO_PDOresolveExtensions(TPDO->SDO, &map->MPDOobject, 1, map->extensions);
+            map->extensionsUsed = TPDO->SDO->ODExtensionsUsed;
+        }
+        CO_PDOcallExtensions(map->extensions, map->noOfExtensions, true);
+#endif
+    }
+    else{
+        CO_MPDOscannerEntry_t *scan;
+
+        if(TPDO->MPDOnoOfScannerEntries == 0) return CO_ERROR_TX_UNCONFIGURED;
+        scan = &TPDO->MPDOscanner[TPDO->MPDOscanEntry];
+        index = (uint16_t)(scan->object >> 8);
+        subIndex = (uint8_t)scan->object + TPDO->MPDOscanOffset;
+        blockSize = (uint8_t)(scan->object >> 24);
+        entryNo = scan->entryNo;
+        data[0] = TPDO->nodeId;
+        CO_OD_getDescriptor(TPDO->SDO, entryNo, subIndex, &desc);
+#ifdef TPDO_CALLS_EXTENSION
+        /* OD extension was added after list was configured */
+        if(scan->extensionsUsed != TPDO->SDO->ODExtensionsUsed){
+            scan->ext = CO_OD_getExtension(TPDO->SDO, entryNo);
+            scan->extensionsUsed = TPDO->SDO->ODExtensionsUsed;
+        }
+        CO_PDOcallExtensionMPDO(scan->ext, &desc, index, subIndex, true);
+#endif
+    }
+    data[1] = (uint8_t)index;
+    data[2] = (uint8_t)(index >> 8);
+    data[3] = subIndex;
+
+    length = (uint8_t)desc.length;
+    if(map->MPDO == CO_PDO_MPDO_DAM && length > (((uint8_t)map->MPDOobject + 7) >> 3)){
+        length = ((uint8_t)map->MPDOobject + 7) >> 3;
+    }
+
+    seq = CO_OD_readBegin(TPDO->SDO, entryNo);
+    CO_PDOcopyMPDO(&data[4], (const uint8_t*)desc.pData, length, desc.attribute);
+
+    /* object was being written, send it later */
+    if(CO_OD_readRetry(TPDO->SDO, entryNo, seq)){
+        TPDO->sendRequest = 1;
+        return CO_ERROR_TX_BUSY;
+    }
+
+    memcpy((void*)&TPDO->CANtxBuff->data[0], (void*)&data[0], 8);
+    ret = CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
+    TPDO->sendRequest = 0;
+
+    if(ret == CO_ERROR_NO && map->MPDO == CO_PDO_MPDO_SAM){
+        if(++TPDO->MPDOscanOffset >= blockSize){
+            TPDO->MPDOscanOffset = 0;
+            if(++TPDO->MPDOscanEntry >= TPDO->MPDOnoOfScannerEntries) TPDO->MPDOscanEntry = 0;
+        }
+        /* event driven producer continues until the end of the list */
+        if(TPDO->eventDriven && (TPDO->MPDOscanEntry != 0 || TPDO->MPDOscanOffset != 0)){
+            TPDO->sendRequest = 1;
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 /*
  * Configure RPDO Mapping parameter.
  *
- * Function is called from communication reset or when parameter changes.
+ * Function is called from communication reset, when parameter changes or
+ * when shadow mapping is staged.
  *
- * Function configures following variables from CO_RPDO_t: _dataLength_ and
- * _mapPointer_.
+ * Function configures following variables from CO_RPDOmap_t: _dataLength_,
+ * _copyPlan_ and _noOfCopies_. Error in active mapping is reported by
+ * emergency, staged mapping is only rejected. MPDO has no copy plan.
  *
  * @param RPDO RPDO object.
+ * @param map Active or shadow mapping of RPDO.
+ * @param pMap Pointer to the first mapped object.
  * @param noOfMappedObjects Number of mapped object (from OD).
  *
  * @return 0 on success, otherwise SDO abort code.
  */
-static uint32_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedObjects){
+static uint32_t CO_RPDOconfigMap(
+        CO_RPDO_t              *RPDO,
+        CO_RPDOmap_t           *map,
+        const uint32_t         *pMap,
+        uint8_t                 noOfMappedObjects)
+{
     int16_t i;
     uint8_t length = 0;
     uint32_t ret = 0;
-    const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
+#ifdef RPDO_CALLS_EXTENSION
+    const uint32_t *pMapFirst = pMap;
+#endif
+
+    map->noOfODentries = 0;
+    map->noOfCopies = 0;
+
+#if CO_CONFIG_MPDO
+    /* MPDO consumer, objects are written by dispatcher */
+    map->MPDO = 0;
+    if(noOfMappedObjects == CO_PDO_MPDO_SAM || noOfMappedObjects == CO_PDO_MPDO_DAM){
+        map->MPDO = noOfMappedObjects;
+        noOfMappedObjects = 0;
+        length = 64;
+    }
+#endif
 
     for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
         uint8_t* pData;
-        uint8_t dummy = 0;
+        uint64_t dummy = 0;
         uint8_t prevLength = length;
-        uint8_t MBvar;
-        uint32_t map = *(pMap++);
+        uint16_t attribute;
+        uint8_t objectLen;
+        uint16_t entryNo;
+        uint32_t mapObj = *(pMap++);
 
         /* function do much checking of errors in map */
         ret = CO_PDOfindMap(
                 RPDO->SDO,
-                map,
+                mapObj,
                 0,
                 &pData,
                 &length,
                 &dummy,
-                &MBvar);
+                &attribute,
+                &objectLen,
+                &entryNo);
         if(ret){
             length = 0;
-            CO_errorReport(RPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+            map->noOfODentries = 0;
+            if(map == RPDO->map){
+                CO_errorReport(RPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, mapObj);
+            }
             break;
         }
 
-        /* write PDO data pointers */
-#ifdef CO_BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                RPDO->mapPointer[j] = pData++;
-        }
-        else{
-            for(j=prevLength; j<length; j++)
-                RPDO->mapPointer[j] = pData++;
-        }
-#else
-        for(j=prevLength; j<length; j++){
-            RPDO->mapPointer[j] = pData++;
-        }
-#endif
+        /* remember OD entry, which is written on reception */
+        CO_PDOaddODentry(map->ODentryNo, &map->noOfODentries, entryNo);
 
+        /* add mapped object to the copy plan */
+        CO_PDOaddCopy(map->copyPlan, &map->noOfCopies, pData, objectLen, attribute, prevLength, length - prevLength);
     }
 
-    RPDO->dataLength = length;
+    if(ret) map->noOfCopies = 0;
+    map->dataLength = (length + 7) >> 3;
+
+#ifdef RPDO_CALLS_EXTENSION
+    map->noOfExtensions = ret ? 0 : CO_PDOresolveExtensions(
+            RPDO->SDO, pMapFirst, noOfMappedObjects, map->extensions);
+    map->extensionsUsed = RPDO->SDO->ODExtensionsUsed;
+#endif
 
     return ret;
 }
 
 
+/*
+ * Add mapped value to TPDO deadband runs, if deadband is defined for it.
+ *
+ * @param TPDO TPDO object.
+ * @param map Active or shadow mapping of TPDO.
+ * @param mapObj PDO mapping parameter.
+ * @param offset Offset of mapped variable in PDO data in bits.
+ * @param length Length of mapped variable in PDO data in bits.
+ */
+static void CO_TPDOaddDeadband(CO_TPDO_t* TPDO, CO_TPDOmap_t *map, uint32_t mapObj, uint8_t offset, uint8_t length){
+    uint16_t index = (uint16_t)(mapObj>>16);
+    uint8_t subIndex = (uint8_t)(mapObj>>8);
+    uint8_t i;
+
+    for(i=0; i<TPDO->noOfDeadbands; i++){
+        const CO_TPDOdeadband_t *db = &TPDO->deadbands[i];
+
+        if(db->index == index && subIndex >= 1 && subIndex <= db->noOfDeltas){
+            CO_TPDOdeadbandRun_t *run = &map->deadbandRun[map->noOfDeadbandRuns++];
+
+            run->mask = CO_PDO_BIT_MASK(length) << offset;
+            run->delta = &db->delta[subIndex - 1];
+            run->offset = offset;
+            run->length = length;
+            run->isSigned = db->isSigned;
+            map->deadbandFlags |= run->mask;
+            return;
+        }
+    }
+}
+
+
 /*
  * Configure TPDO Mapping parameter.
  *
- * Function is called from communication reset or when parameter changes.
+ * Function is called from communication reset, when parameter changes or
+ * when shadow mapping is staged.
  *
- * Function configures following variables from CO_TPDO_t: _dataLength_,
- * _mapPointer_ and _sendIfCOSFlags_.
+ * Function configures following variables from CO_TPDOmap_t: _dataLength_,
+ * _copyPlan_, _noOfCopies_, _sendIfCOSFlags_ and deadband runs. Error in
+ * active mapping is reported by emergency, staged mapping is only rejected.
+ * Entries of staged mapping are added to the reverse index, entries of the
+ * previous mapping are removed from it by the next configuration of active
+ * mapping. Extra entry only causes verification of Change of State. MPDO has
+ * no copy plan, DAM producer verifies only the first mapped object.
  *
  * @param TPDO TPDO object.
+ * @param map Active or shadow mapping of TPDO.
+ * @param pMap Pointer to the first mapped object.
  * @param noOfMappedObjects Number of mapped object (from OD).
  *
  * @return 0 on success, otherwise SDO abort code.
  */
-static uint32_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedObjects){
+static uint32_t CO_TPDOconfigMap(
+        CO_TPDO_t              *TPDO,
+        CO_TPDOmap_t           *map,
+        const uint32_t         *pMap,
+        uint8_t                 noOfMappedObjects)
+{
     int16_t i;
     uint8_t length = 0;
     uint32_t ret = 0;
-    const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
+    uint32_t *ODTPDOMap = TPDO->SDO->ODTPDOMap;
+#ifdef TPDO_CALLS_EXTENSION
+    const uint32_t *pMapFirst = pMap;
+#endif
+
+    map->sendIfCOSFlags = 0;
+    map->deadbandFlags = 0;
+    map->noOfDeadbandRuns = 0;
+    map->noOfODentries = 0;
+    map->noOfCopies = 0;
+
+    /* remove this TPDO from the reverse index */
+    if(ODTPDOMap != NULL && map == TPDO->map){
+        for(i=0; i<TPDO->SDO->ODSize; i++){
+            ODTPDOMap[i] &= ~TPDO->ODTPDOMapBit;
+        }
+    }
 
-    TPDO->sendIfCOSFlags = 0;
+#if CO_CONFIG_MPDO
+    /* MPDO producer sends one object at once, it has no Change of State */
+    map->MPDO = 0;
+    if(noOfMappedObjects == CO_PDO_MPDO_SAM || noOfMappedObjects == CO_PDO_MPDO_DAM){
+        map->MPDO = noOfMappedObjects;
+        map->MPDOobject = *pMap;
+        noOfMappedObjects = 0;
+        length = 64;
+        if(map->MPDO == CO_PDO_MPDO_DAM){
+            CO_OD_descriptor_t desc;
+            uint16_t entryNo = CO_PDOfindMPDO(TPDO->SDO, (uint16_t)(*pMap >> 16), (uint8_t)(*pMap >> 8), 1, &desc);
+
+            if(entryNo == 0xFFFF || (uint8_t)*pMap > 32 || (uint8_t)*pMap == 0){
+                ret = CO_SDO_AB_NO_MAP;   /* Object cannot be mapped to the PDO. */
+                length = 0;
+                if(map == TPDO->map){
+                    CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, *pMap);
+                }
+            }
+            else{
+                /* the only OD entry, which is read on transmission */
+                CO_PDOaddODentry(map->ODentryNo, &map->noOfODentries, entryNo);
+            }
+        }
+    }
+#endif
 
     for(i=noOfMappedObjects; i>0; i--){
-        int16_t j;
         uint8_t* pData;
         uint8_t prevLength = length;
-        uint8_t MBvar;
-        uint32_t map = *(pMap++);
+        uint64_t prevCOSFlags = map->sendIfCOSFlags;
+        uint16_t attribute;
+        uint8_t objectLen;
+        uint16_t entryNo;
+        uint32_t mapObj = *(pMap++);
 
         /* function do much checking of errors in map */
         ret = CO_PDOfindMap(
                 TPDO->SDO,
-                map,
+                mapObj,
                 1,
                 &pData,
                 &length,
-                &TPDO->sendIfCOSFlags,
-                &MBvar);
+                &map->sendIfCOSFlags,
+                &attribute,
+                &objectLen,
+                &entryNo);
         if(ret){
             length = 0;
-            CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, map);
+            map->noOfODentries = 0;
+            if(map == TPDO->map){
+                CO_errorReport(TPDO->em, CO_EM_PDO_WRONG_MAPPING, CO_EMC_PROTOCOL_ERROR, mapObj);
+            }
             break;
         }
 
-        /* write PDO data pointers */
-#ifdef CO_BIG_ENDIAN
-        if(MBvar){
-            for(j=length-1; j>=prevLength; j--)
-                TPDO->mapPointer[j] = pData++;
-        }
-        else{
-            for(j=prevLength; j<length; j++)
-                TPDO->mapPointer[j] = pData++;
+        /* remember OD entry, which is read on transmission */
+        CO_PDOaddODentry(map->ODentryNo, &map->noOfODentries, entryNo);
+
+        /* OD entry with change of state detection triggers this TPDO */
+        if(ODTPDOMap != NULL && entryNo != 0xFFFF && map->sendIfCOSFlags != prevCOSFlags){
+            ODTPDOMap[entryNo] |= TPDO->ODTPDOMapBit;
+            CO_OD_markDirty(TPDO->SDO, entryNo);
         }
-#else
-        for(j=prevLength; j<length; j++){
-            TPDO->mapPointer[j] = pData++;
+
+        /* Change of state of analog value may be limited by deadband */
+        if(map->sendIfCOSFlags != prevCOSFlags){
+            CO_TPDOaddDeadband(TPDO, map, mapObj, prevLength, length - prevLength);
         }
-#endif
 
+        /* add mapped object to the copy plan */
+        CO_PDOaddCopy(map->copyPlan, &map->noOfCopies, pData, objectLen, attribute, prevLength, length - prevLength);
+    }
+
+    if(ret){
+        map->noOfCopies = 0;
+        map->noOfDeadbandRuns = 0;
+        map->deadbandFlags = 0;
     }
+    map->dataLength = (length + 7) >> 3;
 
-    TPDO->dataLength = length;
+#ifdef TPDO_CALLS_EXTENSION
+#if CO_CONFIG_MPDO
+    if(map->MPDO == CO_PDO_MPDO_DAM) noOfMappedObjects = 1;
+#endif
+    map->noOfExtensions = ret ? 0 : CO_PDOresolveExtensions(
+            TPDO->SDO, pMapFirst, noOfMappedObjects, map->extensions);
+    map->extensionsUsed = TPDO->SDO->ODExtensionsUsed;
+#endif
 
     return ret;
 }
 
 
+/*
+ * Place TPDO at position i in the timer queue.
+ */
+static inline void CO_TPDOtimersPlace(CO_TPDOtimers_t *timers, uint16_t i, CO_TPDO_t *TPDO){
+    timers->queue[i] = TPDO;
+    TPDO->queueIndex = i;
+}
+
+
+/*
+ * Move TPDO at position i towards the head of the timer queue.
+ */
+static void CO_TPDOtimersSiftUp(CO_TPDOtimers_t *timers, uint16_t i){
+    CO_TPDO_t *TPDO = timers->queue[i];
+
+    while(i > 0){
+        uint16_t parent = (i - 1) >> 1;
+        if(!CO_PDO_TIME_BEFORE(TPDO->deadline_us, timers->queue[parent]->deadline_us)) break;
+        CO_TPDOtimersPlace(timers, i, timers->queue[parent]);
+        i = parent;
+    }
+    CO_TPDOtimersPlace(timers, i, TPDO);
+}
+
+
+/*
+ * Move TPDO at position i towards the tail of the timer queue.
+ */
+static void CO_TPDOtimersSiftDown(CO_TPDOtimers_t *timers, uint16_t i){
+    CO_TPDO_t *TPDO = timers->queue[i];
+
+    for(;;){
+        uint16_t child = (i << 1) + 1;
+        if(child >= timers->noOfQueued) break;
+        if((child + 1) < timers->noOfQueued &&
+           CO_PDO_TIME_BEFORE(timers->queue[child + 1]->deadline_us, timers->queue[child]->deadline_us)){
+            child++;
+        }
+        if(!CO_PDO_TIME_BEFORE(timers->queue[child]->deadline_us, TPDO->deadline_us)) break;
+        CO_TPDOtimersPlace(timers, i, timers->queue[child]);
+        i = child;
+    }
+    CO_TPDOtimersPlace(timers, i, TPDO);
+}
+
+
+/*
+ * Remove TPDO from the timer queue, if it is queued.
+ */
+static void CO_TPDOtimersRemove(CO_TPDOtimers_t *timers, CO_TPDO_t *TPDO){
+    uint16_t i = TPDO->queueIndex;
+
+    if(i == 0xFFFF) return;
+
+    TPDO->queueIndex = 0xFFFF;
+    timers->noOfQueued--;
+    if(i < timers->noOfQueued){
+        /* move the last TPDO into the gap and restore heap order */
+        CO_TPDO_t *last = timers->queue[timers->noOfQueued];
+        CO_TPDOtimersPlace(timers, i, last);
+        CO_TPDOtimersSiftUp(timers, i);
+        CO_TPDOtimersSiftDown(timers, last->queueIndex);
+    }
+}
+
+
+/*
+ * Insert TPDO into the timer queue or move it to the new deadline.
+ */
+static void CO_TPDOtimersSet(CO_TPDOtimers_t *timers, CO_TPDO_t *TPDO, uint32_t deadline_us){
+    uint16_t i = TPDO->queueIndex;
+
+    if(i == 0xFFFF){
+        i = timers->noOfQueued++;
+        timers->queue[i] = TPDO;
+        TPDO->queueIndex = i;
+    }
+    TPDO->deadline_us = deadline_us;
+    CO_TPDOtimersSiftUp(timers, i);
+    CO_TPDOtimersSiftDown(timers, TPDO->queueIndex);
+}
+
+
+/*
+ * Schedule event driven TPDO according to its state.
+ *
+ * TPDO is processed at the end of inhibit time, if it is active, otherwise
+ * at now_us, if send is requested, otherwise at the end of event timer.
+ * Function must be called inside CO_LOCK_PDO().
+ */
+static void CO_TPDOschedule(CO_TPDO_t *TPDO, uint32_t now_us){
+    CO_TPDOtimers_t *timers = TPDO->timers;
+
+    if(TPDO->valid && timers->operational && TPDO->eventDriven){
+        if(TPDO->inhibitActive){
+            CO_TPDOtimersSet(timers, TPDO, TPDO->inhibitEnd_us);
+            return;
+        }
+        if(TPDO->sendRequest){
+            CO_TPDOtimersSet(timers, TPDO, now_us);
+            return;
+        }
+        if(TPDO->eventTime_us != 0){
+            CO_TPDOtimersSet(timers, TPDO, TPDO->eventEnd_us);
+            return;
+        }
+    }
+    CO_TPDOtimersRemove(timers, TPDO);
+}
+
+
+/*
+ * Start inhibit and event timers after TPDO was sent at now_us.
+ */
+static void CO_TPDOsent(CO_TPDO_t *TPDO, uint32_t now_us){
+    uint32_t inhibitTime_us = ((uint32_t) TPDO->TPDOCommPar->inhibitTime) * 100;
+
+    TPDO->inhibitActive = (inhibitTime_us != 0) ? true : false;
+    TPDO->inhibitEnd_us = now_us + inhibitTime_us;
+    TPDO->eventEnd_us = now_us + TPDO->eventTime_us;
+}
+
+
+/*
+ * Exchange active mapping of RPDO with staged shadow mapping.
+ *
+ * Function is called at the message boundary from CO_RPDO_process() or from
+ * CO_RPDOstageMap(), if RPDO is not valid. Previously active mapping becomes
+ * the shadow mapping. Mapping parameter in Object Dictionary is updated, so it
+ * can be read and stored.
+ */
+static void CO_RPDOswapMap(CO_RPDO_t *RPDO){
+    CO_PDOlists_t *lists = RPDO->lists;
+    CO_RPDOMapPar_t *RPDOMapPar = (CO_RPDOMapPar_t*) RPDO->RPDOMapPar;
+    uint32_t *pMap = &RPDOMapPar->mappedObject1;
+    CO_RPDOmap_t *map;
+    uint8_t i;
+
+    CO_LOCK_PDO();
+    map = RPDO->map;
+    RPDO->map = lists->RPDOshadow;
+    lists->RPDOshadow = map;
+    RPDOMapPar->numberOfMappedObjects = lists->RPDOshadowNoOfMappedObjects;
+    for(i=0; i<8; i++){
+        pMap[i] = (i < lists->RPDOshadowNoOfMappedObjects) ? lists->RPDOshadowMappedObject[i] : 0;
+    }
+    lists->RPDOmapPending = false;
+    lists->RPDOstaged = NULL;
+    CO_UNLOCK_PDO();
+}
+
+
+/*
+ * Exchange active mapping of TPDO with staged shadow mapping.
+ *
+ * Function is called at the message boundary from CO_TPDO_processMap() or
+ * from CO_TPDOstageMap(), if TPDO is not valid. Event driven TPDO is sent with
+ * the new data layout.
+ */
+static void CO_TPDOswapMap(CO_TPDO_t *TPDO){
+    CO_PDOlists_t *lists = TPDO->lists;
+    CO_TPDOMapPar_t *TPDOMapPar = (CO_TPDOMapPar_t*) TPDO->TPDOMapPar;
+    uint32_t *pMap = &TPDOMapPar->mappedObject1;
+    CO_TPDOmap_t *map;
+    uint8_t i;
+
+    CO_LOCK_PDO();
+    map = TPDO->map;
+    TPDO->map = lists->TPDOshadow;
+    lists->TPDOshadow = map;
+    if(TPDO->CANtxBuff != NULL){
+        TPDO->CANtxBuff->DLC = TPDO->map->dataLength;
+    }
+    TPDOMapPar->numberOfMappedObjects = lists->TPDOshadowNoOfMappedObjects;
+    for(i=0; i<8; i++){
+        pMap[i] = (i < lists->TPDOshadowNoOfMappedObjects) ? lists->TPDOshadowMappedObject[i] : 0;
+    }
+    lists->TPDOmapPending = false;
+    lists->TPDOstaged = NULL;
+    if(TPDO->valid && TPDO->eventDriven){
+        TPDO->sendRequest = 1;
+        CO_TPDOschedule(TPDO, TPDO->timers->time_us);
+    }
+    CO_UNLOCK_PDO();
+}
+
+
 /*
  * Function for accessing _RPDO communication parameter_ (index 0x1400+) from SDO server.
  *
@@ -491,7 +1581,8 @@ static CO_SDO_abortCode_t CO_ODF_RPDOcom(CO_ODF_arg_t *ODF_arg){
 
         /* Remove old message from second buffer. */
         if(RPDO->synchronous != synchronousPrev) {
-            RPDO->CANrxNew[1] = false;
+            CO_RPDOdiscard(RPDO, 0x02);
+            CO_RPDOupdateActive(RPDO);
         }
     }
 
@@ -550,8 +1641,13 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
 
         /* configure TPDO */
+        CO_LOCK_PDO();
         CO_TPDOconfigCom(TPDO, *value, TPDO->CANtxBuff->syncFlag);
         TPDO->syncCounter = 255;
+        /* Force first send after PDO becomes valid. */
+        if(TPDO->eventDriven) TPDO->sendRequest = 1;
+        CO_TPDOschedule(TPDO, TPDO->timers->time_us);
+        CO_UNLOCK_PDO();
     }
     else if(ODF_arg->subIndex == 2){   /* Transmission_type */
         uint8_t *value = (uint8_t*) ODF_arg->data;
@@ -559,20 +1655,30 @@ static CO_SDO_abortCode_t CO_ODF_TPDOcom(CO_ODF_arg_t *ODF_arg){
         /* values from 241...253 are not valid */
         if(*value >= 241 && *value <= 253)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
+        CO_LOCK_PDO();
         TPDO->CANtxBuff->syncFlag = (*value <= 240) ? 1 : 0;
         TPDO->syncCounter = 255;
+        TPDO->eventDriven = (*value >= 254) ? true : false;
+        TPDO->eventEnd_us = TPDO->timers->time_us + TPDO->eventTime_us;
+        CO_TPDOupdateActive(TPDO);
+        CO_TPDOschedule(TPDO, TPDO->timers->time_us);
+        CO_UNLOCK_PDO();
     }
     else if(ODF_arg->subIndex == 3){   /* Inhibit_Time */
         /* if PDO is valid, value can not be changed */
         if(TPDO->valid)
             return CO_SDO_AB_INVALID_VALUE;  /* Invalid value for parameter (download only). */
 
-        TPDO->inhibitTimer = 0;
+        TPDO->inhibitActive = false;
     }
     else if(ODF_arg->subIndex == 5){   /* Event_Timer */
         uint16_t *value = (uint16_t*) ODF_arg->data;
 
-        TPDO->eventTimer = ((uint32_t) *value) * 1000;
+        CO_LOCK_PDO();
+        TPDO->eventTime_us = ((uint32_t) *value) * 1000;
+        TPDO->eventEnd_us = TPDO->timers->time_us + TPDO->eventTime_us;
+        CO_TPDOschedule(TPDO, TPDO->timers->time_us);
+        CO_UNLOCK_PDO();
     }
     else if(ODF_arg->subIndex == 6){   /* SYNC start value */
         uint8_t *value = (uint8_t*) ODF_arg->data;
@@ -606,7 +1712,7 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
 
         if(ODF_arg->subIndex == 0){
             /* If there is error in mapping, dataLength is 0, so numberOfMappedObjects is 0. */
-            if(!RPDO->dataLength) *value = 0;
+            if(!RPDO->map->dataLength) *value = 0;
         }
         return CO_SDO_AB_NONE;
     }
@@ -623,11 +1729,21 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
+#if CO_CONFIG_MPDO
+        if(*value > 8 && *value != CO_PDO_MPDO_SAM && *value != CO_PDO_MPDO_DAM)
+#else
         if(*value > 8)
+#endif
             return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
 
-        /* configure mapping */
-        return CO_RPDOconfigMap(RPDO, *value);
+        /* configure mapping, staged mapping is discarded */
+        CO_LOCK_PDO();
+        if(RPDO->lists->RPDOstaged == RPDO){
+            RPDO->lists->RPDOmapPending = false;
+            RPDO->lists->RPDOstaged = NULL;
+        }
+        CO_UNLOCK_PDO();
+        return CO_RPDOconfigMap(RPDO, RPDO->map, &RPDO->RPDOMapPar->mappedObject1, *value);
     }
 
     /* mappedObject */
@@ -635,10 +1751,12 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
         uint32_t *value = (uint32_t*) ODF_arg->data;
         uint8_t* pData;
         uint8_t length = 0;
-        uint8_t dummy = 0;
-        uint8_t MBvar;
+        uint64_t dummy = 0;
+        uint16_t attribute;
+        uint8_t objectLen;
+        uint16_t entryNo;
 
-        if(RPDO->dataLength)
+        if(RPDO->map->dataLength)
             return CO_SDO_AB_UNSUPPORTED_ACCESS;  /* Unsupported access to an object. */
 
         /* verify if mapping is correct */
@@ -649,7 +1767,9 @@ static CO_SDO_abortCode_t CO_ODF_RPDOmap(CO_ODF_arg_t *ODF_arg){
                &pData,
                &length,
                &dummy,
-               &MBvar);
+               &attribute,
+               &objectLen,
+               &entryNo);
     }
 
     return CO_SDO_AB_NONE;
@@ -672,7 +1792,7 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
 
         if(ODF_arg->subIndex == 0){
             /* If there is error in mapping, dataLength is 0, so numberOfMappedObjects is 0. */
-            if(!TPDO->dataLength) *value = 0;
+            if(!TPDO->map->dataLength) *value = 0;
         }
         return CO_SDO_AB_NONE;
     }
@@ -689,11 +1809,21 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
     if(ODF_arg->subIndex == 0){
         uint8_t *value = (uint8_t*) ODF_arg->data;
 
+#if CO_CONFIG_MPDO
+        if(*value > 8 && *value != CO_PDO_MPDO_SAM && *value != CO_PDO_MPDO_DAM)
+#else
         if(*value > 8)
+#endif
             return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
 
-        /* configure mapping */
-        return CO_TPDOconfigMap(TPDO, *value);
+        /* configure mapping, staged mapping is discarded */
+        CO_LOCK_PDO();
+        if(TPDO->lists->TPDOstaged == TPDO){
+            TPDO->lists->TPDOmapPending = false;
+            TPDO->lists->TPDOstaged = NULL;
+        }
+        CO_UNLOCK_PDO();
+        return CO_TPDOconfigMap(TPDO, TPDO->map, &TPDO->TPDOMapPar->mappedObject1, *value);
     }
 
     /* mappedObject */
@@ -701,10 +1831,12 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
         uint32_t *value = (uint32_t*) ODF_arg->data;
         uint8_t* pData;
         uint8_t length = 0;
-        uint8_t dummy = 0;
-        uint8_t MBvar;
+        uint64_t dummy = 0;
+        uint16_t attribute;
+        uint8_t objectLen;
+        uint16_t entryNo;
 
-        if(TPDO->dataLength)
+        if(TPDO->map->dataLength)
             return CO_SDO_AB_UNSUPPORTED_ACCESS;  /* Unsupported access to an object. */
 
         /* verify if mapping is correct */
@@ -715,19 +1847,37 @@ static CO_SDO_abortCode_t CO_ODF_TPDOmap(CO_ODF_arg_t *ODF_arg){
                &pData,
                &length,
                &dummy,
-               &MBvar);
+               &attribute,
+               &objectLen,
+               &entryNo);
     }
 
     return CO_SDO_AB_NONE;
 }
 
 
+/******************************************************************************/
+void CO_PDOlists_init(CO_PDOlists_t *lists){
+    lists->RPDOsync = NULL;
+    lists->RPDOasync = NULL;
+    lists->TPDOsync = NULL;
+    lists->TPDOasync = NULL;
+    lists->RPDOstaged = NULL;
+    lists->RPDOmapPending = false;
+    lists->RPDOshadow = &lists->RPDOmapStorage;
+    lists->TPDOstaged = NULL;
+    lists->TPDOmapPending = false;
+    lists->TPDOshadow = &lists->TPDOmapStorage;
+}
+
+
 /******************************************************************************/
 CO_ReturnError_t CO_RPDO_init(
         CO_RPDO_t              *RPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
         CO_SYNC_t              *SYNC,
+        CO_PDOlists_t          *lists,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
@@ -740,7 +1890,7 @@ CO_ReturnError_t CO_RPDO_init(
         uint16_t                CANdevRxIdx)
 {
     /* verify arguments */
-    if(RPDO==NULL || em==NULL || SDO==NULL || SYNC==NULL || operatingState==NULL ||
+    if(RPDO==NULL || em==NULL || SDO==NULL || SYNC==NULL || lists==NULL || operatingState==NULL ||
         RPDOCommPar==NULL || RPDOMapPar==NULL || CANdevRx==NULL){
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
@@ -749,23 +1899,37 @@ CO_ReturnError_t CO_RPDO_init(
     RPDO->em = em;
     RPDO->SDO = SDO;
     RPDO->SYNC = SYNC;
+    RPDO->lists = lists;
     RPDO->RPDOCommPar = RPDOCommPar;
     RPDO->RPDOMapPar = RPDOMapPar;
     RPDO->operatingState = operatingState;
     RPDO->nodeId = nodeId;
     RPDO->defaultCOB_ID = defaultCOB_ID;
     RPDO->restrictionFlags = restrictionFlags;
+    RPDO->pFunctSignal = NULL;
+    RPDO->activeList = NULL;
+    RPDO->map = &RPDO->mapStorage;
+#if CO_CONFIG_MPDO
+    RPDO->MPDOdispatcher = NULL;
+    RPDO->MPDOnoOfDispatcherEntries = 0;
+    RPDO->MPDOhead = 0;
+    RPDO->MPDOtail = 0;
+    RPDO->MPDOoverflow = false;
+#endif
 
     /* Configure Object dictionary entry at index 0x1400+ and 0x1600+ */
     CO_OD_configure(SDO, idx_RPDOCommPar, CO_ODF_RPDOcom, (void*)RPDO, 0, 0);
     CO_OD_configure(SDO, idx_RPDOMapPar, CO_ODF_RPDOmap, (void*)RPDO, 0, 0);
 
-    /* configure communication and mapping */
-    RPDO->CANrxNew[0] = RPDO->CANrxNew[1] = false;
+    /* configure communication and mapping. Buffers 0 and 1 are ready, without
+     * new message, buffer 2 is owned by receive interrupt, 3 by processing. */
+    RPDO->CANrxState = (0 << CO_RPDO_SLOT_SHIFT(0)) | (1 << CO_RPDO_SLOT_SHIFT(1));
+    RPDO->CANrxWrite = 2;
+    RPDO->CANrxRead = 3;
     RPDO->CANdevRx = CANdevRx;
     RPDO->CANdevRxIdx = CANdevRxIdx;
 
-    CO_RPDOconfigMap(RPDO, RPDOMapPar->numberOfMappedObjects);
+    CO_RPDOconfigMap(RPDO, RPDO->map, &RPDOMapPar->mappedObject1, RPDOMapPar->numberOfMappedObjects);
     CO_RPDOconfigCom(RPDO, RPDOCommPar->COB_IDUsedByRPDO);
 
     return CO_ERROR_NO;
@@ -777,6 +1941,8 @@ CO_ReturnError_t CO_TPDO_init(
         CO_TPDO_t              *TPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_TPDOtimers_t        *timers,
+        CO_PDOlists_t          *lists,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
@@ -785,11 +1951,13 @@ CO_ReturnError_t CO_TPDO_init(
         const CO_TPDOMapPar_t  *TPDOMapPar,
         uint16_t                idx_TPDOCommPar,
         uint16_t                idx_TPDOMapPar,
+        const CO_TPDOdeadband_t *deadbands,
+        uint8_t                 noOfDeadbands,
         CO_CANmodule_t         *CANdevTx,
         uint16_t                CANdevTxIdx)
 {
     /* verify arguments */
-    if(TPDO==NULL || em==NULL || SDO==NULL || operatingState==NULL ||
+    if(TPDO==NULL || em==NULL || SDO==NULL || timers==NULL || lists==NULL || operatingState==NULL ||
         TPDOCommPar==NULL || TPDOMapPar==NULL || CANdevTx==NULL){
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
@@ -797,12 +1965,20 @@ CO_ReturnError_t CO_TPDO_init(
     /* Configure object variables */
     TPDO->em = em;
     TPDO->SDO = SDO;
+    TPDO->timers = timers;
+    TPDO->lists = lists;
     TPDO->TPDOCommPar = TPDOCommPar;
     TPDO->TPDOMapPar = TPDOMapPar;
     TPDO->operatingState = operatingState;
     TPDO->nodeId = nodeId;
     TPDO->defaultCOB_ID = defaultCOB_ID;
     TPDO->restrictionFlags = restrictionFlags;
+    TPDO->deadbands = deadbands;
+    TPDO->noOfDeadbands = (deadbands != NULL) ? noOfDeadbands : 0;
+    TPDO->ODTPDOMapBit = 0;
+    if(SDO->ODTPDOMap != NULL && (uint16_t)(idx_TPDOCommPar - OD_H1800_TXPDO_1_PARAM) < 32){
+        TPDO->ODTPDOMapBit = 1UL << (idx_TPDOCommPar - OD_H1800_TXPDO_1_PARAM);
+    }
 
     /* Configure Object dictionary entry at index 0x1800+ and 0x1A00+ */
     CO_OD_configure(SDO, idx_TPDOCommPar, CO_ODF_TPDOcom, (void*)TPDO, 0, 0);
@@ -812,159 +1988,453 @@ CO_ReturnError_t CO_TPDO_init(
     TPDO->CANdevTx = CANdevTx;
     TPDO->CANdevTxIdx = CANdevTxIdx;
     TPDO->syncCounter = 255;
-    TPDO->inhibitTimer = 0;
-    TPDO->eventTimer = ((uint32_t) TPDOCommPar->eventTimer) * 1000;
-    if(TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
+    TPDO->eventDriven = (TPDOCommPar->transmissionType>=254) ? true : false;
+    TPDO->inhibitActive = false;
+    TPDO->sending = false;
+    TPDO->eventTime_us = ((uint32_t) TPDOCommPar->eventTimer) * 1000;
+    TPDO->eventEnd_us = timers->time_us + TPDO->eventTime_us;
+    TPDO->queueIndex = 0xFFFF;
+    TPDO->activeList = NULL;
+    TPDO->map = &TPDO->mapStorage;
+#if CO_CONFIG_MPDO
+    TPDO->MPDOscanner = NULL;
+    TPDO->MPDOnoOfScannerEntries = 0;
+    TPDO->MPDOdestination = 0;
+    TPDO->MPDOscanEntry = 0;
+    TPDO->MPDOscanOffset = 0;
+#endif
+    if(TPDO->eventDriven) TPDO->sendRequest = 1;
 
-    CO_TPDOconfigMap(TPDO, TPDOMapPar->numberOfMappedObjects);
+    CO_TPDOconfigMap(TPDO, TPDO->map, &TPDOMapPar->mappedObject1, TPDOMapPar->numberOfMappedObjects);
     CO_TPDOconfigCom(TPDO, TPDOCommPar->COB_IDUsedByTPDO, ((TPDOCommPar->transmissionType<=240) ? 1 : 0));
 
     if((TPDOCommPar->transmissionType>240 &&
          TPDOCommPar->transmissionType<254) ||
          TPDOCommPar->SYNCStartValue>240){
             TPDO->valid = false;
+            CO_TPDOupdateActive(TPDO);
+    }
+    CO_TPDOschedule(TPDO, timers->time_us);
+
+    return CO_ERROR_NO;
+}
+
+
+#if CO_CONFIG_MPDO
+/******************************************************************************/
+CO_ReturnError_t CO_RPDO_initMPDO(
+        CO_RPDO_t              *RPDO,
+        CO_MPDOdispatcherEntry_t dispatcher[],
+        uint8_t                 noOfDispatcherEntries)
+{
+    uint8_t i;
+
+    if(RPDO == NULL || (dispatcher == NULL && noOfDispatcherEntries != 0)){
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* verify local objects and resolve their OD entries */
+    for(i=0; i<noOfDispatcherEntries; i++){
+        uint64_t entry = dispatcher[i].object;
+        uint8_t blockSize = (uint8_t)(entry >> 56);
+        uint8_t nodeId = (uint8_t)(entry >> 24);
+        uint16_t entryNo = 0xFFFF;
+        uint8_t j;
+
+        if(nodeId == 0 || nodeId > 127) return CO_ERROR_ILLEGAL_ARGUMENT;
+        if(blockSize == 0) blockSize = 1;
+        for(j=0; j<blockSize; j++){
+            CO_OD_descriptor_t desc;
+
+            entryNo = CO_PDOfindMPDO(RPDO->SDO, (uint16_t)(entry >> 40), (uint8_t)(entry >> 32) + j, 0, &desc);
+            if(entryNo == 0xFFFF){
+                return CO_ERROR_ILLEGAL_ARGUMENT;
+            }
+        }
+        dispatcher[i].entryNo = entryNo;
+#ifdef RPDO_CALLS_EXTENSION
+        dispatcher[i].ext = CO_OD_getExtension(RPDO->SDO, entryNo);
+        dispatcher[i].extensionsUsed = RPDO->SDO->ODExtensionsUsed;
+#endif
+    }
+
+    CO_LOCK_PDO();
+    RPDO->MPDOdispatcher = dispatcher;
+    RPDO->MPDOnoOfDispatcherEntries = noOfDispatcherEntries;
+    CO_UNLOCK_PDO();
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_TPDO_initMPDO(
+        CO_TPDO_t              *TPDO,
+        CO_MPDOscannerEntry_t   scanner[],
+        uint8_t                 noOfScannerEntries,
+        uint8_t                 destinationNodeId)
+{
+    uint8_t i;
+
+    if(TPDO == NULL || (scanner == NULL && noOfScannerEntries != 0) || destinationNodeId > 127){
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* verify scanned objects and resolve their OD entries */
+    for(i=0; i<noOfScannerEntries; i++){
+        uint32_t entry = scanner[i].object;
+        uint8_t blockSize = (uint8_t)(entry >> 24);
+        uint16_t entryNo = 0xFFFF;
+        uint8_t j;
+
+        if(blockSize == 0) blockSize = 1;
+        for(j=0; j<blockSize; j++){
+            CO_OD_descriptor_t desc;
+
+            entryNo = CO_PDOfindMPDO(TPDO->SDO, (uint16_t)(entry >> 8), (uint8_t)entry + j, 1, &desc);
+            if(entryNo == 0xFFFF){
+                return CO_ERROR_ILLEGAL_ARGUMENT;
+            }
+        }
+        scanner[i].entryNo = entryNo;
+#ifdef TPDO_CALLS_EXTENSION
+        scanner[i].ext = CO_OD_getExtension(TPDO->SDO, entryNo);
+        scanner[i].extensionsUsed = TPDO->SDO->ODExtensionsUsed;
+#endif
     }
 
+    CO_LOCK_PDO();
+    TPDO->MPDOscanner = scanner;
+    TPDO->MPDOnoOfScannerEntries = noOfScannerEntries;
+    TPDO->MPDOdestination = destinationNodeId;
+    TPDO->MPDOscanEntry = 0;
+    TPDO->MPDOscanOffset = 0;
+    CO_UNLOCK_PDO();
+
     return CO_ERROR_NO;
 }
+#endif
+
+
+/******************************************************************************/
+CO_SDO_abortCode_t CO_RPDOstageMap(
+        CO_RPDO_t              *RPDO,
+        const uint32_t          mappedObjects[],
+        uint8_t                 noOfMappedObjects)
+{
+    CO_PDOlists_t *lists = RPDO->lists;
+    CO_RPDO_t *staged;
+    uint32_t ret;
+    uint8_t i;
+
+    if(noOfMappedObjects == 0 || noOfMappedObjects > 8)
+        return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
+
+    /* Take the shadow mapping. Previously staged mapping of this RPDO is
+     * taken back, it is not exchanged any more. */
+    CO_LOCK_PDO();
+    staged = lists->RPDOstaged;
+    if(staged == NULL || staged == RPDO){
+        lists->RPDOmapPending = false;
+        lists->RPDOstaged = RPDO;
+    }
+    CO_UNLOCK_PDO();
+    if(staged != NULL && staged != RPDO)
+        return CO_SDO_AB_DATA_DEV_STATE;  /* Mapping of other RPDO is staged. */
+
+    /* verify and compile mapping in the background */
+    for(i=0; i<noOfMappedObjects; i++){
+        lists->RPDOshadowMappedObject[i] = mappedObjects[i];
+    }
+    lists->RPDOshadowNoOfMappedObjects = noOfMappedObjects;
+    ret = CO_RPDOconfigMap(RPDO, lists->RPDOshadow, &lists->RPDOshadowMappedObject[0], noOfMappedObjects);
+    if(ret == 0 && lists->RPDOshadow->dataLength == 0) ret = CO_SDO_AB_MAP_LEN;
+
+    /* valid RPDO exchanges mapping at the next message boundary */
+    CO_LOCK_PDO();
+    if(ret)                lists->RPDOstaged = NULL;
+    else if(RPDO->valid)   lists->RPDOmapPending = true;
+    else                   CO_RPDOswapMap(RPDO);
+    CO_UNLOCK_PDO();
+
+    return (CO_SDO_abortCode_t) ret;
+}
+
+
+/******************************************************************************/
+CO_SDO_abortCode_t CO_TPDOstageMap(
+        CO_TPDO_t              *TPDO,
+        const uint32_t          mappedObjects[],
+        uint8_t                 noOfMappedObjects)
+{
+    CO_PDOlists_t *lists = TPDO->lists;
+    CO_TPDO_t *staged;
+    uint32_t ret;
+    uint8_t i;
+
+    if(noOfMappedObjects == 0 || noOfMappedObjects > 8)
+        return CO_SDO_AB_MAP_LEN;  /* Number and length of object to be mapped exceeds PDO length. */
+
+    /* Take the shadow mapping. Previously staged mapping of this TPDO is
+     * taken back, it is not exchanged any more. */
+    CO_LOCK_PDO();
+    staged = lists->TPDOstaged;
+    if(staged == NULL || staged == TPDO){
+        lists->TPDOmapPending = false;
+        lists->TPDOstaged = TPDO;
+    }
+    CO_UNLOCK_PDO();
+    if(staged != NULL && staged != TPDO)
+        return CO_SDO_AB_DATA_DEV_STATE;  /* Mapping of other TPDO is staged. */
+
+    /* verify and compile mapping in the background */
+    for(i=0; i<noOfMappedObjects; i++){
+        lists->TPDOshadowMappedObject[i] = mappedObjects[i];
+    }
+    lists->TPDOshadowNoOfMappedObjects = noOfMappedObjects;
+    ret = CO_TPDOconfigMap(TPDO, lists->TPDOshadow, &lists->TPDOshadowMappedObject[0], noOfMappedObjects);
+    if(ret == 0 && lists->TPDOshadow->dataLength == 0) ret = CO_SDO_AB_MAP_LEN;
+
+    /* valid TPDO exchanges mapping at the next message boundary */
+    CO_LOCK_PDO();
+    if(ret)                lists->TPDOstaged = NULL;
+    else if(TPDO->valid)   lists->TPDOmapPending = true;
+    else                   CO_TPDOswapMap(TPDO);
+    CO_UNLOCK_PDO();
+
+    return (CO_SDO_abortCode_t) ret;
+}
+
+
+/*
+ * Get value of TPDO deadband run from 64 bit PDO data word.
+ */
+static inline int64_t CO_TPDOdeadbandValue(const CO_TPDOdeadbandRun_t *run, uint64_t word){
+    uint64_t value = (word & run->mask) >> run->offset;
+
+    /* sign extension */
+    if(run->isSigned && run->length < 64 && (value & (1ULL << (run->length - 1)))){
+        value |= ~CO_PDO_BIT_MASK(run->length);
+    }
+    return (int64_t) value;
+}
+
+
+/******************************************************************************/
+void CO_RPDO_initCallback(
+        CO_RPDO_t              *RPDO,
+        void                  (*pFunctSignal)(void))
+{
+    if(RPDO != NULL){
+        RPDO->pFunctSignal = pFunctSignal;
+    }
+}
 
 
 /******************************************************************************/
 uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
+    /* mapping may be exchanged meanwhile by higher priority context */
+    const CO_TPDOmap_t *map = TPDO->map;
+    uint8_t data[8] = {0};
+    uint64_t image, sent, changed;
+    uint8_t i;
 
     /* Prepare TPDO data automatically from Object Dictionary variables */
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
+    CO_PDOpack(&data[0], map->copyPlan, map->noOfCopies);
+
+    /* Compare all bits with previously sent data at once */
+    image = CO_PDOgetBits(&data[0], 8, false);
+    sent = CO_PDOgetBits(&TPDO->CANtxBuff->data[0], 8, false);
+    changed = (image ^ sent) & map->sendIfCOSFlags;
 
-    pPDOdataByte = &TPDO->CANtxBuff->data[TPDO->dataLength];
-    ppODdataByte = &TPDO->mapPointer[TPDO->dataLength];
+    /* Change of value without deadband */
+    if(changed & ~map->deadbandFlags) return 1;
 
-    switch(TPDO->dataLength){
-        case 8: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x80)) return 1;
-        case 7: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x40)) return 1;
-        case 6: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x20)) return 1;
-        case 5: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x10)) return 1;
-        case 4: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x08)) return 1;
-        case 3: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x04)) return 1;
-        case 2: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x02)) return 1;
-        case 1: if(*(--pPDOdataByte) != **(--ppODdataByte) && (TPDO->sendIfCOSFlags&0x01)) return 1;
+    /* Change of analog value must exceed its deadband */
+    for(i=0; changed && i<map->noOfDeadbandRuns; i++){
+        const CO_TPDOdeadbandRun_t *run = &map->deadbandRun[i];
+
+        if(changed & run->mask){
+            int64_t newValue = CO_TPDOdeadbandValue(run, image);
+            int64_t sentValue = CO_TPDOdeadbandValue(run, sent);
+            uint64_t diff = (newValue > sentValue) ? (uint64_t)(newValue - sentValue)
+                                                   : (uint64_t)(sentValue - newValue);
+
+            if(diff > *run->delta) return 1;
+            changed &= ~run->mask;
+        }
     }
 
     return 0;
 }
 
-//#define TPDO_CALLS_EXTENSION
 /******************************************************************************/
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
+    CO_TPDOmap_t *map = TPDO->map;
     int16_t i;
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
+    uint8_t data[8] = {0};
+    uint16_t seq[8];
+    bool_t consistent;
+
+#if CO_CONFIG_MPDO
+    /* MPDO carries one object */
+    if(map->MPDO != 0){
+        return CO_TPDOsendMPDO(TPDO, map);
+    }
+#endif
 
 #ifdef TPDO_CALLS_EXTENSION
-    if(TPDO->SDO->ODExtensions){
-        /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-        const uint32_t* pMap = &TPDO->TPDOMapPar->mappedObject1;
-        CO_SDO_t *pSDO = TPDO->SDO;
-
-        for(i=TPDO->TPDOMapPar->numberOfMappedObjects; i>0; i--){
-            uint32_t map = *(pMap++);
-            uint16_t index = (uint16_t)(map>>16);
-            uint8_t subIndex = (uint8_t)(map>>8);
-            uint16_t entryNo = CO_OD_find(pSDO, index);
-            if ( entryNo == 0xFFFF ) continue;
-            CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-            if( ext->pODFunc == NULL) continue;
-            CO_ODF_arg_t ODF_arg;
-            memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-            ODF_arg.reading = true;
-            ODF_arg.index = index;
-            ODF_arg.subIndex = subIndex;
-            ODF_arg.object = ext->object;
-            ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-            ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-            ODF_arg.data = pSDO->OD[entryNo].pData;
-            ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-            ext->pODFunc(&ODF_arg);
-        }
+    /* OD extension was added after mapping was configured */
+    if(map->extensionsUsed != TPDO->SDO->ODExtensionsUsed && map->noOfCopies > 0){
+        map->noOfExtensions = CO_PDOresolveExtensions(TPDO->SDO,
+                &TPDO->TPDOMapPar->mappedObject1, TPDO->TPDOMapPar->numberOfMappedObjects, map->extensions);
+        map->extensionsUsed = TPDO->SDO->ODExtensionsUsed;
     }
+    CO_PDOcallExtensions(map->extensions, map->noOfExtensions, true);
 #endif
-    i = TPDO->dataLength;
-    pPDOdataByte = &TPDO->CANtxBuff->data[0];
-    ppODdataByte = &TPDO->mapPointer[0];
+    for(i=0; i<map->noOfODentries; i++){
+        seq[i] = CO_OD_readBegin(TPDO->SDO, map->ODentryNo[i]);
+    }
 
     /* Copy data from Object dictionary. */
-    for(; i>0; i--) {
-        *(pPDOdataByte++) = **(ppODdataByte++);
+    CO_PDOpack(&data[0], map->copyPlan, map->noOfCopies);
+
+    /* TPDO interrupts the writer, so it can not wait for consistent data. If
+     * OD entry was being written, send nothing and request new sending. */
+    consistent = true;
+    for(i=0; i<map->noOfODentries; i++){
+        if(CO_OD_readRetry(TPDO->SDO, map->ODentryNo[i], seq[i])) consistent = false;
+    }
+    if(!consistent){
+        TPDO->sendRequest = 1;
+        return CO_ERROR_TX_BUSY;
     }
 
+    memcpy((void*)&TPDO->CANtxBuff->data[0], (void*)&data[0], map->dataLength);
     TPDO->sendRequest = 0;
 
     return CO_CANsend(TPDO->CANdevTx, TPDO->CANtxBuff);
 }
 
-//#define RPDO_CALLS_EXTENSION
+/******************************************************************************/
+int16_t CO_TPDOsendNow(CO_TPDO_t *TPDO){
+    CO_TPDOtimers_t *timers = TPDO->timers;
+    int16_t ret = CO_ERROR_TX_UNCONFIGURED;
+    bool_t send = false;
+    uint32_t now_us = 0;
+
+    CO_LOCK_PDO();
+    if(TPDO->valid && timers->operational && TPDO->eventDriven && !TPDO->sending){
+        /* Time was last updated by CO_TPDOtimers_process(). Time since then is
+         * not longer than its period, otherwise real time context was stopped. */
+        uint32_t elapsed_us = CO_TIMER_TICKS_TO_US(CO_TIMER_TICKS() - timers->processTicks);
+
+        if(elapsed_us > timers->processPeriod_us) elapsed_us = timers->processPeriod_us;
+        now_us = timers->time_us + elapsed_us;
+
+        if(!TPDO->inhibitActive || !CO_PDO_TIME_BEFORE(now_us, TPDO->inhibitEnd_us)){
+            TPDO->inhibitActive = false;
+            TPDO->sending = true;
+            send = true;
+        }
+    }
+    if(!send){
+        TPDO->sendRequest = 1;
+        CO_TPDOschedule(TPDO, timers->time_us);
+    }
+    CO_UNLOCK_PDO();
+
+    if(!send){
+        return ret;
+    }
+
+    /* Extensions, packing and CAN driver run with interrupts enabled */
+    ret = CO_TPDOsend(TPDO);
+
+    CO_LOCK_PDO();
+    if(ret == CO_ERROR_NO){
+        CO_TPDOsent(TPDO, now_us);
+    }
+    else{
+        TPDO->sendRequest = 1;
+    }
+    TPDO->sending = false;
+    CO_TPDOschedule(TPDO, timers->time_us);
+    CO_UNLOCK_PDO();
+
+    return ret;
+}
+
+
+/******************************************************************************/
+void CO_TPDOrequestSend(CO_TPDO_t *TPDO){
+    CO_LOCK_PDO();
+    TPDO->sendRequest = 1;
+    CO_TPDOschedule(TPDO, TPDO->timers->time_us);
+    CO_UNLOCK_PDO();
+}
+
 /******************************************************************************/
 void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
 
     if(!RPDO->valid || !(*RPDO->operatingState == CO_NMT_OPERATIONAL))
     {
-        RPDO->CANrxNew[0] = RPDO->CANrxNew[1] = false;
+        CO_RPDOdiscard(RPDO, 0x03);
+#if CO_CONFIG_MPDO
+        RPDO->MPDOtail = RPDO->MPDOhead;
+    }
+    else if(RPDO->map->MPDO != 0)
+    {
+        if(!RPDO->synchronous || syncWas) CO_RPDOprocessMPDO(RPDO);
+#endif
     }
     else if(!RPDO->synchronous || syncWas)
     {
-        uint8_t bufNo = 0;
-
-        /* Determine, which of the two rx buffers, contains relevant message. */
-        if(RPDO->synchronous && !RPDO->SYNC->CANrxToggle) {
-            bufNo = 1;
-        }
+        /* Determine, which of the two ready buffers contains relevant message.
+         * Synchronous message was received before the last SYNC. */
+        uint8_t shift = CO_RPDO_SLOT_SHIFT((RPDO->synchronous && !RPDO->SYNC->CANrxToggle) ? 1 : 0);
 
-        while(RPDO->CANrxNew[bufNo]){
+        if((RPDO->CANrxState >> shift) & CO_RPDO_SLOT_NEW){
+            CO_RPDOmap_t *map = RPDO->map;
             int16_t i;
-            uint8_t* pPDOdataByte;
-            uint8_t** ppODdataByte;
-
-            i = RPDO->dataLength;
-            pPDOdataByte = &RPDO->CANrxData[bufNo][0];
-            ppODdataByte = &RPDO->mapPointer[0];
-
-            /* Copy data to Object dictionary. If between the copy operation CANrxNew
-             * is set to true by receive thread, then copy the latest data again. */
-            RPDO->CANrxNew[bufNo] = false;
-            for(; i>0; i--) {
-                **(ppODdataByte++) = *(pPDOdataByte++);
+            uint8_t state;
+
+            /* Take the latest complete message and give own buffer back.
+             * Receive interrupt never writes into taken buffer, so data are
+             * copied once. Readers of mapped OD entries retry, if they are
+             * interrupted here. CO_OD_writeEnd() also marks entries as
+             * changed for TPDOs. */
+            state = CO_RPDOexchange(RPDO, CO_RPDO_SLOT_MASK << shift, RPDO->CANrxRead << shift);
+            RPDO->CANrxRead = (state >> shift) & CO_RPDO_SLOT_BUFFER;
+            CO_MEMORY_BARRIER();
+
+            for(i=0; i<map->noOfODentries; i++){
+                CO_OD_writeBegin(RPDO->SDO, map->ODentryNo[i]);
+            }
+            CO_PDOunpack(&RPDO->CANrxData[RPDO->CANrxRead][0], map->copyPlan, map->noOfCopies);
+            for(i=0; i<map->noOfODentries; i++){
+                CO_OD_writeEnd(RPDO->SDO, map->ODentryNo[i]);
             }
 
 #ifdef RPDO_CALLS_EXTENSION
-            if(RPDO->SDO->ODExtensions){
-                /* for each mapped OD, check mapping to see if an OD extension is available, and call it if it is */
-                const uint32_t* pMap = &RPDO->RPDOMapPar->mappedObject1;
-                CO_SDO_t *pSDO = RPDO->SDO;
-
-                for(i=RPDO->RPDOMapPar->numberOfMappedObjects; i>0; i--){
-                    uint32_t map = *(pMap++);
-                    uint16_t index = (uint16_t)(map>>16);
-                    uint8_t subIndex = (uint8_t)(map>>8);
-                    uint16_t entryNo = CO_OD_find(pSDO, index);
-                    if ( entryNo == 0xFFFF ) continue;
-                    CO_OD_extension_t *ext = &pSDO->ODExtensions[entryNo];
-                    if( ext->pODFunc == NULL) continue;
-                    CO_ODF_arg_t ODF_arg;
-                    memset((void*)&ODF_arg, 0, sizeof(CO_ODF_arg_t));
-                    ODF_arg.reading = false;
-                    ODF_arg.index = index;
-                    ODF_arg.subIndex = subIndex;
-                    ODF_arg.object = ext->object;
-                    ODF_arg.attribute = CO_OD_getAttribute(pSDO, entryNo, subIndex);
-                    ODF_arg.pFlags = CO_OD_getFlagsPointer(pSDO, entryNo, subIndex);
-                    ODF_arg.data = pSDO->OD[entryNo].pData;
-                    ODF_arg.dataLength = CO_OD_getLength(pSDO, entryNo, subIndex);
-                    ext->pODFunc(&ODF_arg);
-                }
+            /* OD extension was added after mapping was configured */
+            if(map->extensionsUsed != RPDO->SDO->ODExtensionsUsed && map->noOfCopies > 0){
+                map->noOfExtensions = CO_PDOresolveExtensions(RPDO->SDO,
+                        &RPDO->RPDOMapPar->mappedObject1, RPDO->RPDOMapPar->numberOfMappedObjects, map->extensions);
+                map->extensionsUsed = RPDO->SDO->ODExtensionsUsed;
             }
+            CO_PDOcallExtensions(map->extensions, map->noOfExtensions, false);
 #endif
         }
     }
+
+    /* Message received before was processed with the old mapping. Synchronous
+     * RPDO exchanges mapping only at SYNC. */
+    if(RPDO->lists->RPDOmapPending && RPDO->lists->RPDOstaged == RPDO &&
+        (syncWas || !RPDO->synchronous))
+    {
+        CO_RPDOswapMap(RPDO);
+    }
 }
 
 
@@ -972,24 +2442,15 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
 void CO_TPDO_process(
         CO_TPDO_t              *TPDO,
         CO_SYNC_t              *SYNC,
-        bool_t                  syncWas,
-        uint32_t                timeDifference_us)
+        bool_t                  syncWas)
 {
-    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
+    /* TPDOs after this SYNC are sent with the new mapping */
+    CO_TPDO_processMap(TPDO, syncWas);
 
-        /* Send PDO by application request or by Event timer */
-        if(TPDO->TPDOCommPar->transmissionType >= 253){
-            if(TPDO->inhibitTimer == 0 && (TPDO->sendRequest || (TPDO->TPDOCommPar->eventTimer && TPDO->eventTimer == 0))){
-                if(CO_TPDOsend(TPDO) == CO_ERROR_NO){
-                    /* successfully sent */
-                    TPDO->inhibitTimer = ((uint32_t) TPDO->TPDOCommPar->inhibitTime) * 100;
-                    TPDO->eventTimer = ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
-                }
-            }
-        }
+    if(TPDO->valid && *TPDO->operatingState == CO_NMT_OPERATIONAL){
 
-        /* Synchronous PDOs */
-        else if(SYNC && syncWas){
+        /* Synchronous PDOs, event driven PDOs are sent by CO_TPDOtimers_process() */
+        if(!TPDO->eventDriven && SYNC && syncWas){
             /* send synchronous acyclic PDO */
             if(TPDO->TPDOCommPar->transmissionType == 0){
                 if(TPDO->sendRequest) CO_TPDOsend(TPDO);
@@ -1019,13 +2480,142 @@ void CO_TPDO_process(
         }
 
     }
-    else{
-        /* Not operational or valid. Force TPDO first send after operational or valid. */
-        if(TPDO->TPDOCommPar->transmissionType>=254) TPDO->sendRequest = 1;
-        else                                         TPDO->sendRequest = 0;
+    else if(!TPDO->eventDriven){
+        /* Not operational or valid. Event driven TPDOs are rescheduled by CO_TPDOtimers_process(). */
+        TPDO->sendRequest = 0;
+    }
+}
+
+
+/******************************************************************************/
+void CO_TPDO_processMap(CO_TPDO_t *TPDO, bool_t syncWas){
+    /* Event driven TPDO is sent with the new mapping next time, synchronous
+     * TPDO after this SYNC */
+    if(TPDO->lists->TPDOmapPending && TPDO->lists->TPDOstaged == TPDO &&
+        (syncWas || TPDO->eventDriven))
+    {
+        CO_TPDOswapMap(TPDO);
+    }
+}
+
+
+/******************************************************************************/
+void CO_TPDOtimers_init(
+        CO_TPDOtimers_t        *timers,
+        CO_TPDO_t              *TPDOs[],
+        CO_TPDO_t              *queue[],
+        uint16_t                noOfTPDOs,
+        uint8_t                *operatingState)
+{
+    timers->TPDOs = TPDOs;
+    timers->queue = queue;
+    timers->noOfTPDOs = noOfTPDOs;
+    timers->noOfQueued = 0;
+    timers->operatingState = operatingState;
+    timers->operational = (*operatingState == CO_NMT_OPERATIONAL) ? true : false;
+    timers->time_us = 0;
+    timers->processTicks = CO_TIMER_TICKS();
+    timers->processPeriod_us = 0;
+}
+
+
+/******************************************************************************/
+void CO_TPDOtimers_process(
+        CO_TPDOtimers_t        *timers,
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us)
+{
+    bool_t operational = (*timers->operatingState == CO_NMT_OPERATIONAL) ? true : false;
+    bool_t stateChanged;
+    uint16_t i;
+
+    CO_LOCK_PDO();
+    timers->time_us += timeDifference_us;
+    timers->processTicks = CO_TIMER_TICKS();
+    timers->processPeriod_us = timeDifference_us;
+    stateChanged = (operational != timers->operational) ? true : false;
+    timers->operational = operational;
+    CO_UNLOCK_PDO();
+
+    /* NMT state changed, start all event driven TPDOs from the beginning.
+     * Force first send after operational. */
+    if(stateChanged){
+        for(i=0; i<timers->noOfTPDOs; i++){
+            CO_TPDO_t *TPDO = timers->TPDOs[i];
+
+            CO_LOCK_PDO();
+            TPDO->inhibitActive = false;
+            TPDO->eventEnd_us = timers->time_us + TPDO->eventTime_us;
+            if(TPDO->eventDriven) TPDO->sendRequest = 1;
+            CO_TPDOschedule(TPDO, timers->time_us);
+            CO_UNLOCK_PDO();
+        }
+    }
+
+    /* Visit only TPDOs with expired deadline. Lock is held only while the
+     * queue and timers are changed, TPDO is sent with interrupts enabled. */
+    for(;;){
+        CO_TPDO_t *TPDO = NULL;
+        bool_t send = false;
+
+        CO_LOCK_PDO();
+        if(timers->noOfQueued > 0 &&
+           !CO_PDO_TIME_BEFORE(timers->time_us, timers->queue[0]->deadline_us))
+        {
+            TPDO = timers->queue[0];
+
+            if(TPDO->inhibitActive && !CO_PDO_TIME_BEFORE(timers->time_us, TPDO->inhibitEnd_us)){
+                TPDO->inhibitActive = false;
+            }
+            /* Other context is sending it, it reschedules the TPDO afterwards */
+            if(TPDO->sending){
+                CO_TPDOtimersRemove(timers, TPDO);
+            }
+            else if(!TPDO->inhibitActive && (TPDO->sendRequest ||
+                    (TPDO->eventTime_us != 0 && !CO_PDO_TIME_BEFORE(timers->time_us, TPDO->eventEnd_us))))
+            {
+                TPDO->sending = true;
+                CO_TPDOtimersRemove(timers, TPDO);
+                send = true;
+            }
+            else{
+                CO_TPDOschedule(TPDO, timers->time_us + 1);
+            }
+        }
+        CO_UNLOCK_PDO();
+
+        if(TPDO == NULL){
+            break;
+        }
+        if(send){
+            int16_t ret = CO_TPDOsend(TPDO);
+
+            CO_LOCK_PDO();
+            if(ret == CO_ERROR_NO){
+                CO_TPDOsent(TPDO, timers->time_us);
+            }
+            else{
+                TPDO->sendRequest = 1;
+            }
+            TPDO->sending = false;
+            /* retry of unsuccessful send is delayed to the next call */
+            CO_TPDOschedule(TPDO, timers->time_us + 1);
+            CO_UNLOCK_PDO();
+        }
     }
 
-    /* update timers */
-    TPDO->inhibitTimer = (TPDO->inhibitTimer > timeDifference_us) ? (TPDO->inhibitTimer - timeDifference_us) : 0;
-    TPDO->eventTimer = (TPDO->eventTimer > timeDifference_us) ? (TPDO->eventTimer - timeDifference_us) : 0;
+    CO_LOCK_PDO();
+    /* Lower timerNext_us to the earliest deadline */
+    if(timerNext_us != NULL && timers->noOfQueued > 0){
+        uint32_t diff = timers->queue[0]->deadline_us - timers->time_us;
+
+        if(CO_PDO_TIME_BEFORE(timers->queue[0]->deadline_us, timers->time_us)) diff = 0;
+        if(*timerNext_us > diff) *timerNext_us = diff;
+    }
+
+    /* next call may come later than after timeDifference_us */
+    if(timerNext_us != NULL && *timerNext_us > timeDifference_us){
+        timers->processPeriod_us = *timerNext_us;
+    }
+    CO_UNLOCK_PDO();
 }
@@ -69,7 +69,7 @@ extern "C" {
  *
  * Features of the PDO as implemented here, in CANopenNode:
  *  - Dynamic PDO mapping.
- *  - Map granularity of one byte.
+ *  - Map granularity of one bit, up to 64 bits in PDO.
  *  - After RPDO is received from CAN bus, its data are copied to buffer.
  *    Function CO_RPDO_process() (called by application) copies data to
  *    mapped objects in Object Dictionary. Synchronous RPDOs are processed AFTER
@@ -77,9 +77,36 @@ extern "C" {
  *  - Function CO_TPDO_process() (called by application) sends TPDO if
  *    necessary. There are possible different transmission types, including
  *    automatic detection of Change of State of specific variable.
+ *  - Shadow mapping. Valid PDO is remapped without the invalidation sequence,
+ *    see CO_RPDOstageMap() and CO_TPDOstageMap(). New mapping is verified
+ *    in the background and exchanged with the active one at the next message
+ *    boundary: at SYNC for synchronous PDO, otherwise after received RPDO is
+ *    processed or before TPDO is sent.
+ *  - Multiplexed PDO (MPDO), see #CO_PDO_MPDO_SAM and #CO_CONFIG_MPDO.
  */
 
 
+/**
+ * If defined, @ref CO_SDO_OD_function of each mapped object with OD extension
+ * is called after received RPDO data are written to Object Dictionary. With
+ * TPDO_CALLS_EXTENSION it is called before TPDO data are read. Extensions are
+ * resolved from PDO mapping, see #CO_PDOextension_t.
+ */
+//#define RPDO_CALLS_EXTENSION
+//#define TPDO_CALLS_EXTENSION
+
+
+/**
+ * If nonzero, PDOs may be multiplexed, see #CO_PDO_MPDO_SAM. Otherwise RPDOs
+ * and TPDOs do not carry MPDO queue and object lists, CO_RPDO_initMPDO() and
+ * CO_TPDO_initMPDO() are not available and _numberOfMappedObjects_ 254 and
+ * 255 are rejected.
+ */
+#ifndef CO_CONFIG_MPDO
+    #define CO_CONFIG_MPDO      0
+#endif
+
+
 /**
  * RPDO communication parameter. The same as record from Object dictionary (index 0x1400+).
  */
@@ -108,7 +135,7 @@ typedef struct{
     this value must be 0. */
     uint8_t             numberOfMappedObjects;
     /** Location and size of the mapped object. Bit meanings `0xIIIISSLL`:
-        - Bit  0-7:  Data Length in bits.
+        - Bit  0-7:  Data Length in bits, 1 to 64, any bit offset in PDO.
         - Bit 8-15:  Subindex from object distionary.
         - Bit 16-31: Index from object distionary. */
     uint32_t            mappedObject1;
@@ -165,7 +192,7 @@ typedef struct{
     this value must be 0. */
     uint8_t             numberOfMappedObjects;
     /** Location and size of the mapped object. Bit meanings `0xIIIISSLL`:
-        - Bit  0-7:  Data Length in bits.
+        - Bit  0-7:  Data Length in bits, 1 to 64, any bit offset in PDO.
         - Bit 8-15:  Subindex from object distionary.
         - Bit 16-31: Index from object distionary. */
     uint32_t            mappedObject1;
@@ -180,12 +207,266 @@ typedef struct{
 
 
 /**
- * RPDO object.
+ * One run of PDO copy plan. Copy plan is compiled from PDO mapping.
+ *
+ * Run copies _length_ bits between PDO data at _offset_ and OD variable at
+ * _pData_. Byte runs are byte aligned in PDO data. Mapped objects, which
+ * follow each other in PDO and in memory, are merged into one byte run, so
+ * run is copied with single 16/32/64 bit access or with memcpy(). Other
+ * mapped objects are bit runs, which are copied with shift and _mask_. Bit run
+ * writes whole multibyte OD variable, see #CO_ODA_SIGNED.
+ */
+typedef struct{
+    /** Mask of run bits in 64 bit PDO data word, zero for byte run */
+    uint64_t            mask;
+    uint8_t            *pData;          /**< Pointer to mapped OD variable */
+    uint8_t             offset;         /**< Offset of run in PDO data in bits, 0 to 63 */
+    uint8_t             length;         /**< Length of run in bits, 1 to 64 */
+    uint8_t             size;           /**< Bytes of OD variable accessed by bit run */
+    bool_t              isSigned;       /**< True, if bit run is sign extended into OD variable */
+#ifdef CO_BIG_ENDIAN
+    bool_t              swap;           /**< True for multibyte variable, bytes are reversed */
+#endif
+}CO_PDOcopy_t;
+
+
+/**
+ * Deadband for Change of State detection of analog values mapped to TPDO.
+ *
+ * Mapped sub-index N of OD object _index_ triggers TPDO by Change of State
+ * only, if its value differs from the last sent value by more than
+ * delta[N-1]. Reference is the last sent value, so slowly drifting value is
+ * sent, when accumulated change exceeds delta (hysteresis). Deltas are read
+ * on each verification, so they may be changed by SDO (for example CiA 401
+ * object 0x6426 for analog inputs 0x6401).
+ */
+typedef struct{
+    uint16_t            index;          /**< Index of OD array with analog values */
+    bool_t              isSigned;       /**< True, if values are signed integers */
+    uint8_t             noOfDeltas;     /**< Number of elements in delta */
+    const uint32_t     *delta;          /**< Deltas for sub-indexes from 1, 0 means any change */
+}CO_TPDOdeadband_t;
+
+
+/**
+ * Mapped value of TPDO with deadband. Compiled from PDO mapping.
+ */
+typedef struct{
+    uint64_t            mask;           /**< Mask of value bits in 64 bit PDO data word */
+    const uint32_t     *delta;          /**< Pointer to delta from CO_TPDOdeadband_t */
+    uint8_t             offset;         /**< Offset of value in PDO data in bits */
+    uint8_t             length;         /**< Length of value in bits */
+    bool_t              isSigned;       /**< True, if value is signed integer */
+}CO_TPDOdeadbandRun_t;
+
+
+/**
+ * Multiplexed PDO (MPDO), CiA 301.
+ *
+ * PDO with _numberOfMappedObjects_ 254 (source address mode, SAM) or 255
+ * (destination address mode, DAM) in mapping parameter is MPDO. MPDO has
+ * always 8 bytes: address in byte 0 (bit 7 set for DAM, bits 0..6 Node-ID),
+ * index in bytes 1..2, sub-index in byte 3 and data of one object, up to 32
+ * bits, in bytes 4..7. So one COB-ID carries many objects:
+ *  - SAM producer (TPDO) sends objects from the object scanner list round
+ *    robin, one object on each transmission, with own Node-ID. Event driven
+ *    TPDO sends whole list after event timer or send request, one object
+ *    after another, limited by inhibit time. SAM consumer (RPDO) writes
+ *    received objects to Object Dictionary according to the object
+ *    dispatcher list. Lists are set by CO_TPDO_initMPDO() and
+ *    CO_RPDO_initMPDO().
+ *  - DAM producer sends the first mapped object to the destination node,
+ *    0 for all nodes. DAM consumer writes the object with received index and
+ *    sub-index, if it is mappable to RPDO.
+ *
+ * Received MPDOs are queued by CAN receive interrupt, so more of them may be
+ * received between two CO_RPDO_process() calls, see #CO_MPDO_QUEUE_SIZE.
+ * MPDOs are enabled by #CO_CONFIG_MPDO.
+ */
+#define CO_PDO_MPDO_SAM         254
+#define CO_PDO_MPDO_DAM         255    /**< See #CO_PDO_MPDO_SAM */
+
+#if CO_CONFIG_MPDO
+
+/**
+ * Entry of MPDO object scanner list, as in OD index 0x1FA0+.
+ *
+ * Object is sent by SAM producer with sub-indexes from _subIndex_ to
+ * _subIndex_ + _blockSize_ - 1. Block size 0 is the same as 1.
+ */
+#define CO_MPDO_SCANNER_ENTRY(index, subIndex, blockSize) \
+    (((uint32_t)(blockSize) << 24) | ((uint32_t)(index) << 8) | (uint32_t)(subIndex))
+
+/**
+ * Entry of MPDO object dispatcher list, as in OD index 0x1FD0+.
+ *
+ * Object _index_, _subIndex_ from SAM producer _nodeId_ is written to
+ * _localIndex_, _localSubIndex_. Block of _blockSize_ sub-indexes is
+ * dispatched by one entry. Block size 0 is the same as 1.
+ */
+#define CO_MPDO_DISPATCHER_ENTRY(nodeId, index, subIndex, localIndex, localSubIndex, blockSize) \
+    (((uint64_t)(blockSize) << 56) | ((uint64_t)(localIndex) << 40) | \
+     ((uint64_t)(localSubIndex) << 32) | ((uint64_t)(nodeId) << 24) | \
+     ((uint64_t)(index) << 8) | (uint64_t)(subIndex))
+
+/**
+ * Number of received MPDOs buffered for each RPDO, power of two. One less
+ * is usable. If queue is full, MPDO is discarded and CO_EM_RPDO_OVERFLOW is
+ * reported.
+ */
+#ifndef CO_MPDO_QUEUE_SIZE
+    #define CO_MPDO_QUEUE_SIZE  8
+#endif
+
+/**
+ * Entry of MPDO object scanner list with resolved Object Dictionary entry.
+ *
+ * Application sets _object_, other members are set by CO_TPDO_initMPDO(), so
+ * MPDO producer does not search Object Dictionary on each message.
+ */
+typedef struct{
+    /** Scanned objects, see CO_MPDO_SCANNER_ENTRY() */
+    uint32_t            object;
+    /** Sequence number of OD entry with scanned objects */
+    uint16_t            entryNo;
+#ifdef TPDO_CALLS_EXTENSION
+    /** CO_SDO_t::ODExtensionsUsed, when ext was resolved */
+    uint16_t            extensionsUsed;
+    /** OD extension of entryNo or NULL */
+    CO_OD_extension_t  *ext;
+#endif
+}CO_MPDOscannerEntry_t;
+
+/**
+ * Entry of MPDO object dispatcher list with resolved Object Dictionary entry.
+ *
+ * Application sets _object_, other members are set by CO_RPDO_initMPDO().
  */
 typedef struct{
+    /** Dispatched objects, see CO_MPDO_DISPATCHER_ENTRY() */
+    uint64_t            object;
+    /** Sequence number of OD entry with local objects */
+    uint16_t            entryNo;
+#ifdef RPDO_CALLS_EXTENSION
+    /** CO_SDO_t::ODExtensionsUsed, when ext was resolved */
+    uint16_t            extensionsUsed;
+    /** OD extension of entryNo or NULL */
+    CO_OD_extension_t  *ext;
+#endif
+}CO_MPDOdispatcherEntry_t;
+#endif /* CO_CONFIG_MPDO */
+
+
+#if defined(RPDO_CALLS_EXTENSION) || defined(TPDO_CALLS_EXTENSION)
+/**
+ * Mapped object with OD extension.
+ *
+ * It is resolved from PDO mapping and contains all constant arguments for
+ * @ref CO_SDO_OD_function, so PDO processing does not search Object
+ * Dictionary. Extension never moves, its function, object and flags are read
+ * on each call.
+ */
+typedef struct{
+    CO_OD_extension_t  *ext;            /**< Extension of mapped OD entry */
+    void               *pData;          /**< Pointer to mapped variable */
+    uint16_t            dataLength;     /**< Length of mapped variable in OD */
+    uint16_t            attribute;      /**< Attribute of mapped variable */
+    uint16_t            index;          /**< Index of mapped object */
+    uint8_t             subIndex;       /**< Subindex of mapped object */
+}CO_PDOextension_t;
+#endif
+
+
+/**
+ * RPDO mapping, compiled from _RPDO mapping parameter_.
+ *
+ * RPDO has active mapping. One shadow mapping for all RPDOs is in
+ * CO_PDOlists_t, see CO_RPDOstageMap().
+ */
+typedef struct{
+    /** Data length of the received PDO message */
+    uint8_t             dataLength;
+#if CO_CONFIG_MPDO
+    /** 0, #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM */
+    uint8_t             MPDO;
+#endif
+    /** Number of runs in copyPlan */
+    uint8_t             noOfCopies;
+    /** Copy plan, by which received PDO data are copied to OD variables */
+    CO_PDOcopy_t        copyPlan[8];
+    /** Number of OD entries in ODentryNo */
+    uint8_t             noOfODentries;
+    /** Sequence numbers of mapped OD entries, each only once. PDO is copied
+    between CO_OD_writeBegin() and CO_OD_writeEnd() on them. */
+    uint16_t            ODentryNo[8];
+#ifdef RPDO_CALLS_EXTENSION
+    /** Number of mapped objects with OD extension */
+    uint8_t             noOfExtensions;
+    /** CO_SDO_t::ODExtensionsUsed, when extensions were resolved */
+    uint16_t            extensionsUsed;
+    /** Mapped objects with OD extension */
+    CO_PDOextension_t   extensions[8];
+#endif
+}CO_RPDOmap_t;
+
+
+/**
+ * TPDO mapping, compiled from _TPDO mapping parameter_.
+ *
+ * TPDO has active mapping. One shadow mapping for all TPDOs is in
+ * CO_PDOlists_t, see CO_TPDOstageMap().
+ */
+typedef struct{
+    /** Data length of the transmitting PDO message */
+    uint8_t             dataLength;
+#if CO_CONFIG_MPDO
+    /** 0, #CO_PDO_MPDO_SAM or #CO_PDO_MPDO_DAM */
+    uint8_t             MPDO;
+    /** Object sent by DAM producer, the first mapped object */
+    uint32_t            MPDOobject;
+#endif
+    /** Number of runs in copyPlan */
+    uint8_t             noOfCopies;
+    /** Copy plan, by which OD variables are copied to PDO data */
+    CO_PDOcopy_t        copyPlan[8];
+    /** Number of OD entries in ODentryNo */
+    uint8_t             noOfODentries;
+    /** Sequence numbers of mapped OD entries, each only once. Their sequence
+    counters are verified, when PDO is copied, see CO_OD_readBegin(). */
+    uint16_t            ODentryNo[8];
+#ifdef TPDO_CALLS_EXTENSION
+    /** Number of mapped objects with OD extension */
+    uint8_t             noOfExtensions;
+    /** CO_SDO_t::ODExtensionsUsed, when extensions were resolved */
+    uint16_t            extensionsUsed;
+    /** Mapped objects with OD extension */
+    CO_PDOextension_t   extensions[8];
+#endif
+    /** Each flag bit is connected with one bit of PDO data. If flag bit
+    is true, CO_TPDOisCOS() function will detect
+    Change of State on OD variable mapped to that bit */
+    uint64_t            sendIfCOSFlags;
+    /** Bits of sendIfCOSFlags, which are verified against deadband */
+    uint64_t            deadbandFlags;
+    /** Number of values in deadbandRun */
+    uint8_t             noOfDeadbandRuns;
+    /** Mapped values with deadband */
+    CO_TPDOdeadbandRun_t deadbandRun[8];
+}CO_TPDOmap_t;
+
+
+/** Lists of valid PDOs, see CO_PDOlists_init(). */
+typedef struct CO_PDOlists_t CO_PDOlists_t;
+
+
+/**
+ * RPDO object.
+ */
+typedef struct CO_RPDO_t{
     CO_EM_t            *em;             /**< From CO_RPDO_init() */
     CO_SDO_t           *SDO;            /**< From CO_RPDO_init() */
     CO_SYNC_t          *SYNC;           /**< From CO_RPDO_init() */
+    CO_PDOlists_t      *lists;          /**< From CO_RPDO_init() */
     const CO_RPDOCommPar_t *RPDOCommPar;/**< From CO_RPDO_init() */
     const CO_RPDOMapPar_t  *RPDOMapPar; /**< From CO_RPDO_init() */
     uint8_t            *operatingState; /**< From CO_RPDO_init() */
@@ -196,25 +477,59 @@ typedef struct{
     bool_t              valid;
     /** True, if PDO synchronous (transmissionType <= 240) */
     bool_t              synchronous;
-    /** Data length of the received PDO message. Calculated from mapping */
-    uint8_t             dataLength;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
-    /** Variable indicates, if new PDO message received from CAN bus. */
-    volatile bool_t     CANrxNew[2];
-    /** 8 data bytes of the received message. */
-    uint8_t             CANrxData[2][8];
+    /** Active mapping. Calculated from mapping parameter */
+    CO_RPDOmap_t       *map;
+    /** Storage of one mapping. It is exchanged by pointer with the shadow
+    mapping in CO_PDOlists_t, so map may point to other storage. */
+    CO_RPDOmap_t        mapStorage;
+    /** Ready receive buffers, exchanged atomically. Bits 0..2 are for
+    asynchronous RPDO or for synchronous RPDO received while
+    CO_SYNC_t::CANrxToggle is false, bits 3..5 for CANrxToggle true. In each
+    group bits 0..1 are buffer index and bit 2 is set for new message. */
+    volatile uint8_t    CANrxState;
+    /** Receive buffer owned by CAN receive interrupt */
+    uint8_t             CANrxWrite;
+    /** Receive buffer owned by CO_RPDO_process() */
+    uint8_t             CANrxRead;
+    /** 8 data bytes of received messages, see CANrxState */
+    uint8_t             CANrxData[4][8];
+    /** From CO_RPDO_initCallback() or NULL */
+    void              (*pFunctSignal)(void);
+#if CO_CONFIG_MPDO
+    /** Object dispatcher list, from CO_RPDO_initMPDO() or NULL */
+    CO_MPDOdispatcherEntry_t *MPDOdispatcher;
+    /** Number of entries in MPDOdispatcher */
+    uint8_t             MPDOnoOfDispatcherEntries;
+    /** Position in MPDOqueue, written by CAN receive interrupt */
+    volatile uint8_t    MPDOhead;
+    /** Position in MPDOqueue, written by CO_RPDO_process() */
+    volatile uint8_t    MPDOtail;
+    /** Set by CAN receive interrupt, if MPDOqueue was full */
+    volatile bool_t     MPDOoverflow;
+    /** Received MPDOs, from MPDOtail to MPDOhead */
+    uint8_t             MPDOqueue[CO_MPDO_QUEUE_SIZE][8];
+#endif
+    /** Head of the list in CO_PDOlists_t, which contains this RPDO, or NULL */
+    struct CO_RPDO_t  **activeList;
+    struct CO_RPDO_t   *activePrev;     /**< Previous RPDO in activeList */
+    struct CO_RPDO_t   *activeNext;     /**< Next RPDO in activeList */
     CO_CANmodule_t     *CANdevRx;       /**< From CO_RPDO_init() */
     uint16_t            CANdevRxIdx;    /**< From CO_RPDO_init() */
 }CO_RPDO_t;
 
 
+/** Timer queue of event driven TPDOs, see CO_TPDOtimers_init(). */
+typedef struct CO_TPDOtimers_t CO_TPDOtimers_t;
+
+
 /**
  * TPDO object.
  */
-typedef struct{
+typedef struct CO_TPDO_t{
     CO_EM_t            *em;             /**< From CO_TPDO_init() */
     CO_SDO_t           *SDO;            /**< From CO_TPDO_init() */
+    CO_TPDOtimers_t    *timers;         /**< From CO_TPDO_init() */
+    CO_PDOlists_t      *lists;          /**< From CO_TPDO_init() */
     const CO_TPDOCommPar_t *TPDOCommPar;/**< From CO_TPDO_init() */
     const CO_TPDOMapPar_t  *TPDOMapPar; /**< From CO_TPDO_init() */
     uint8_t            *operatingState; /**< From CO_TPDO_init() */
@@ -222,29 +537,148 @@ typedef struct{
     uint16_t            defaultCOB_ID;  /**< From CO_TPDO_init() */
     uint8_t             restrictionFlags;/**< From CO_TPDO_init() */
     bool_t              valid;          /**< True, if PDO is enabled and valid */
-    /** Data length of the transmitting PDO message. Calculated from mapping */
-    uint8_t             dataLength;
-    /** If application set this flag, PDO will be later sent by
-    function CO_TPDO_process(). Depends on transmission type. */
+    /** If set, PDO will be later sent by CO_TPDOtimers_process() or by
+    CO_TPDO_process(). Depends on transmission type. Application sets it
+    with CO_TPDOrequestSend(). */
     uint8_t             sendRequest;
-    /** Pointers to 8 data objects, where PDO will be copied */
-    uint8_t            *mapPointer[8];
-    /** Each flag bit is connected with one mapPointer. If flag bit
-    is true, CO_TPDO_process() functiuon will send PDO if
-    Change of State is detected on value pointed by that mapPointer */
-    uint8_t             sendIfCOSFlags;
+    /** Active mapping. Calculated from mapping parameter */
+    CO_TPDOmap_t       *map;
+    /** Storage of one mapping. It is exchanged by pointer with the shadow
+    mapping in CO_PDOlists_t, so map may point to other storage. */
+    CO_TPDOmap_t        mapStorage;
+    const CO_TPDOdeadband_t *deadbands; /**< From CO_TPDO_init() */
+    uint8_t             noOfDeadbands;  /**< From CO_TPDO_init() */
+#if CO_CONFIG_MPDO
+    /** Object scanner list, from CO_TPDO_initMPDO() or NULL */
+    CO_MPDOscannerEntry_t *MPDOscanner;
+    /** Number of entries in MPDOscanner */
+    uint8_t             MPDOnoOfScannerEntries;
+    /** Node-ID of DAM consumer, 0 for all nodes, from CO_TPDO_initMPDO() */
+    uint8_t             MPDOdestination;
+    /** Entry of MPDOscanner, which is sent next */
+    uint8_t             MPDOscanEntry;
+    /** Sub-index offset inside block of the above entry */
+    uint8_t             MPDOscanOffset;
+#endif
+    /** Bit of this TPDO in CO_SDO_t::ODTPDOMap. If zero, TPDO is not in the
+    reverse index and its Change of State is verified on each cycle. */
+    uint32_t            ODTPDOMapBit;
     /** SYNC counter used for PDO sending */
     uint8_t             syncCounter;
-    /** Inhibit timer used for inhibit PDO sending translated to microseconds */
-    uint32_t            inhibitTimer;
-    /** Event timer used for PDO sending translated to microseconds */
-    uint32_t            eventTimer;
+    /** True, if transmission type is 254 or 255 */
+    bool_t              eventDriven;
+    /** True, if inhibit time after the last sending has not expired yet */
+    bool_t              inhibitActive;
+    /** True, while TPDO is being sent outside CO_LOCK_PDO(). Other contexts
+     * do not send it meanwhile, they leave _sendRequest_ instead. */
+    volatile bool_t     sending;
+    /** Event timer from communication parameter in microseconds */
+    uint32_t            eventTime_us;
+    /** Time in CO_TPDOtimers_t::time_us, when inhibit time expires */
+    uint32_t            inhibitEnd_us;
+    /** Time in CO_TPDOtimers_t::time_us, when event timer expires */
+    uint32_t            eventEnd_us;
+    /** Time in CO_TPDOtimers_t::time_us, when TPDO must be processed */
+    uint32_t            deadline_us;
+    /** Position of TPDO in CO_TPDOtimers_t::queue, 0xFFFF if not queued */
+    uint16_t            queueIndex;
+    /** Head of the list in CO_PDOlists_t, which contains this TPDO, or NULL */
+    struct CO_TPDO_t  **activeList;
+    struct CO_TPDO_t   *activePrev;     /**< Previous TPDO in activeList */
+    struct CO_TPDO_t   *activeNext;     /**< Next TPDO in activeList */
     CO_CANmodule_t     *CANdevTx;       /**< From CO_TPDO_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer inside CANdev */
     uint16_t            CANdevTxIdx;    /**< From CO_TPDO_init() */
 }CO_TPDO_t;
 
 
+/**
+ * Timer queue of event driven TPDOs.
+ *
+ * Queue is a binary min-heap of TPDOs, ordered by their deadline. TPDO is in
+ * the queue, if it is valid, event driven and it has pending inhibit time,
+ * send request or event timer. Cost of CO_TPDOtimers_process() is
+ * proportional to the number of expired deadlines, not to the number of
+ * TPDOs. Times are in microseconds, sum of timeDifference_us, and are
+ * compared across overflow.
+ */
+struct CO_TPDOtimers_t{
+    CO_TPDO_t         **TPDOs;          /**< From CO_TPDOtimers_init() */
+    CO_TPDO_t         **queue;          /**< From CO_TPDOtimers_init() */
+    uint16_t            noOfTPDOs;      /**< From CO_TPDOtimers_init() */
+    uint16_t            noOfQueued;     /**< Number of TPDOs in queue */
+    uint8_t            *operatingState; /**< From CO_TPDOtimers_init() */
+    /** NMT operational state at previous CO_TPDOtimers_process() call */
+    bool_t              operational;
+    /** Current time */
+    uint32_t            time_us;
+    /** CO_TIMER_TICKS() at previous CO_TPDOtimers_process() call */
+    uint32_t            processTicks;
+    /** Longer of timeDifference_us and timerNext_us from previous
+    CO_TPDOtimers_process() call, limits time elapsed since processTicks */
+    uint32_t            processPeriod_us;
+};
+
+
+/**
+ * Lists of valid PDOs.
+ *
+ * Each valid PDO is linked into one list, according to its transmission type.
+ * Lists are maintained, when communication parameters are configured, so
+ * cyclic processing visits only valid PDOs of the relevant class, not all
+ * configured PDO objects. Lists are modified inside CO_LOCK_PDO().
+ *
+ * Object also contains one shadow mapping for RPDOs and one for TPDOs, see
+ * CO_RPDOstageMap(). Only one mapping of each direction may be staged at a
+ * time, so PDO objects do not need own shadow mapping.
+ */
+struct CO_PDOlists_t{
+    CO_RPDO_t          *RPDOsync;       /**< Synchronous RPDOs, transmission type 0...240 */
+    CO_RPDO_t          *RPDOasync;      /**< Asynchronous RPDOs, transmission type 254, 255 */
+    CO_TPDO_t          *TPDOsync;       /**< Synchronous TPDOs, transmission type 0...240 */
+    CO_TPDO_t          *TPDOasync;      /**< Event driven TPDOs, transmission type 254, 255 */
+    /** RPDO, which owns RPDOshadow, or NULL */
+    CO_RPDO_t * volatile RPDOstaged;
+    /** True, if RPDOshadow is complete and waits for exchange with the active
+    mapping of RPDOstaged. Shadow mapping is not modified while it is set. */
+    volatile bool_t     RPDOmapPending;
+    /** Number of objects in RPDOshadowMappedObject */
+    uint8_t             RPDOshadowNoOfMappedObjects;
+    /** Mapping parameter of RPDOshadow, copied into Object Dictionary, when
+    mapping is exchanged */
+    uint32_t            RPDOshadowMappedObject[8];
+    /** Shadow RPDO mapping, exchanged by pointer with the active mapping */
+    CO_RPDOmap_t       *RPDOshadow;
+    /** Initial storage of RPDOshadow */
+    CO_RPDOmap_t        RPDOmapStorage;
+    /** TPDO, which owns TPDOshadow, or NULL */
+    CO_TPDO_t * volatile TPDOstaged;
+    /** True, if TPDOshadow is complete and waits for exchange with the active
+    mapping of TPDOstaged. Shadow mapping is not modified while it is set. */
+    volatile bool_t     TPDOmapPending;
+    /** Number of objects in TPDOshadowMappedObject */
+    uint8_t             TPDOshadowNoOfMappedObjects;
+    /** Mapping parameter of TPDOshadow, copied into Object Dictionary, when
+    mapping is exchanged */
+    uint32_t            TPDOshadowMappedObject[8];
+    /** Shadow TPDO mapping, exchanged by pointer with the active mapping */
+    CO_TPDOmap_t       *TPDOshadow;
+    /** Initial storage of TPDOshadow */
+    CO_TPDOmap_t        TPDOmapStorage;
+};
+
+
+/**
+ * Initialize lists of valid PDOs.
+ *
+ * Function must be called in the communication reset section, before
+ * CO_RPDO_init() and CO_TPDO_init() of any PDO.
+ *
+ * @param lists This object will be initialized.
+ */
+void CO_PDOlists_init(CO_PDOlists_t *lists);
+
+
 /**
  * Initialize RPDO object.
  *
@@ -253,6 +687,8 @@ typedef struct{
  * @param RPDO This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO server object.
+ * @param SYNC SYNC object.
+ * @param lists Lists of valid PDOs, initialized with CO_PDOlists_init().
  * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
  * @param nodeId CANopen Node ID of this device. If default COB_ID is used, value will be added.
  * @param defaultCOB_ID Default COB ID for this PDO (without NodeId).
@@ -279,6 +715,7 @@ CO_ReturnError_t CO_RPDO_init(
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
         CO_SYNC_t              *SYNC,
+        CO_PDOlists_t          *lists,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
@@ -291,6 +728,26 @@ CO_ReturnError_t CO_RPDO_init(
         uint16_t                CANdevRxIdx);
 
 
+/**
+ * Initialize timer queue of event driven TPDOs.
+ *
+ * Function must be called in the communication reset section, before
+ * CO_TPDO_init() of any TPDO.
+ *
+ * @param timers This object will be initialized.
+ * @param TPDOs Array of all TPDO objects, used on NMT state change.
+ * @param queue Storage for the queue, noOfTPDOs pointers.
+ * @param noOfTPDOs Number of elements in TPDOs and queue.
+ * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
+ */
+void CO_TPDOtimers_init(
+        CO_TPDOtimers_t        *timers,
+        CO_TPDO_t              *TPDOs[],
+        CO_TPDO_t              *queue[],
+        uint16_t                noOfTPDOs,
+        uint8_t                *operatingState);
+
+
 /**
  * Initialize TPDO object.
  *
@@ -299,6 +756,9 @@ CO_ReturnError_t CO_RPDO_init(
  * @param TPDO This object will be initialized.
  * @param em Emergency object.
  * @param SDO SDO object.
+ * @param timers Timer queue of event driven TPDOs, initialized with
+ * CO_TPDOtimers_init().
+ * @param lists Lists of valid PDOs, initialized with CO_PDOlists_init().
  * @param operatingState Pointer to variable indicating CANopen device NMT internal state.
  * @param nodeId CANopen Node ID of this device. If default COB_ID is used, value will be added.
  * @param defaultCOB_ID Default COB ID for this PDO (without NodeId).
@@ -313,8 +773,12 @@ CO_ReturnError_t CO_RPDO_init(
  * dictionary (index 0x1400+).
  * @param TPDOMapPar Pointer to _TPDO mapping parameter_ record from Object
  * dictionary (index 0x1600+).
- * @param idx_TPDOCommPar Index in Object Dictionary.
+ * @param idx_TPDOCommPar Index in Object Dictionary. TPDO number, derived from
+ * it, selects bit of this TPDO in CO_SDO_t::ODTPDOMap.
  * @param idx_TPDOMapPar Index in Object Dictionary.
+ * @param deadbands Deadbands for Change of State detection of mapped analog
+ * values. May be NULL.
+ * @param noOfDeadbands Number of elements in deadbands.
  * @param CANdevTx CAN device used for PDO transmission.
  * @param CANdevTxIdx Index of transmit buffer in the above CAN device.
  *
@@ -324,6 +788,8 @@ CO_ReturnError_t CO_TPDO_init(
         CO_TPDO_t              *TPDO,
         CO_EM_t                *em,
         CO_SDO_t               *SDO,
+        CO_TPDOtimers_t        *timers,
+        CO_PDOlists_t          *lists,
         uint8_t                *operatingState,
         uint8_t                 nodeId,
         uint16_t                defaultCOB_ID,
@@ -332,19 +798,143 @@ CO_ReturnError_t CO_TPDO_init(
         const CO_TPDOMapPar_t  *TPDOMapPar,
         uint16_t                idx_TPDOCommPar,
         uint16_t                idx_TPDOMapPar,
+        const CO_TPDOdeadband_t *deadbands,
+        uint8_t                 noOfDeadbands,
         CO_CANmodule_t         *CANdevTx,
         uint16_t                CANdevTxIdx);
 
 
+/**
+ * Initialize RPDO callback function.
+ *
+ * Function initializes optional callback function, which is called after
+ * asynchronous RPDO is received from the CAN bus. Function may trigger
+ * processing of RPDOs and TPDOs, so response TPDO is not delayed until the
+ * next cycle of the real time context.
+ *
+ * @param RPDO This object.
+ * @param pFunctSignal Pointer to the callback function. Not called if NULL.
+ */
+void CO_RPDO_initCallback(
+        CO_RPDO_t              *RPDO,
+        void                  (*pFunctSignal)(void));
+
+
+#if CO_CONFIG_MPDO
+/**
+ * Initialize MPDO consumer.
+ *
+ * Function may be called after CO_RPDO_init(). It sets object dispatcher list
+ * used by RPDO in source address mode, see #CO_PDO_MPDO_SAM. RPDO becomes
+ * MPDO consumer, when its _numberOfMappedObjects_ is 254 or 255.
+ *
+ * @param RPDO This object.
+ * @param dispatcher Object dispatcher list, see CO_MPDOdispatcherEntry_t.
+ * Local objects must be mappable to RPDO, writeable and up to 4 bytes long.
+ * Their OD entries are resolved here. Array must exist during lifetime of
+ * RPDO. May be NULL.
+ * @param noOfDispatcherEntries Number of entries in dispatcher.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_RPDO_initMPDO(
+        CO_RPDO_t              *RPDO,
+        CO_MPDOdispatcherEntry_t dispatcher[],
+        uint8_t                 noOfDispatcherEntries);
+
+
+/**
+ * Initialize MPDO producer.
+ *
+ * Function may be called after CO_TPDO_init(). It sets object scanner list
+ * used by TPDO in source address mode and destination of TPDO in destination
+ * address mode, see #CO_PDO_MPDO_SAM. TPDO becomes MPDO producer, when its
+ * _numberOfMappedObjects_ is 254 or 255. The same scanner list may be used by
+ * more TPDOs.
+ *
+ * @param TPDO This object.
+ * @param scanner Object scanner list, see CO_MPDOscannerEntry_t. Objects
+ * must be mappable to TPDO, readable and up to 4 bytes long. Their OD entries
+ * are resolved here. Array must exist during lifetime of TPDO. May be NULL.
+ * @param noOfScannerEntries Number of entries in scanner.
+ * @param destinationNodeId Node-ID of DAM consumer, 0 for all nodes.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_TPDO_initMPDO(
+        CO_TPDO_t              *TPDO,
+        CO_MPDOscannerEntry_t   scanner[],
+        uint8_t                 noOfScannerEntries,
+        uint8_t                 destinationNodeId);
+#endif
+
+
+/**
+ * Stage new mapping of RPDO.
+ *
+ * Function is called by application in the background (mainline), to remap
+ * RPDO without the invalidation sequence of _RPDO mapping parameter_. Mapping
+ * is verified and compiled into the shadow mapping here. If RPDO is valid,
+ * shadow mapping becomes active in CO_RPDO_process() at the next message
+ * boundary: synchronous RPDO after the next SYNC, asynchronous RPDO after
+ * already received message is processed. Message received before is still
+ * processed with the old mapping, so no cycle is lost. If RPDO is not valid,
+ * mapping is activated immediately. Mapping parameter in Object Dictionary is
+ * updated, when mapping becomes active. Previously staged and not yet active
+ * mapping of the same RPDO is replaced. Configuration of mapping by SDO
+ * discards staged mapping.
+ *
+ * Shadow mapping is shared by all RPDOs in CO_PDOlists_t, so mapping of other
+ * RPDO can not be staged, until the staged one becomes active.
+ *
+ * @param RPDO This object.
+ * @param mappedObjects Mapped objects, the same as mappedObjectN in
+ * #CO_RPDOMapPar_t.
+ * @param noOfMappedObjects Number of mapped objects, 1 to 8.
+ *
+ * @return 0 on success, otherwise SDO abort code. Active mapping is then not
+ * changed. CO_SDO_AB_DATA_DEV_STATE, if mapping of other RPDO is staged.
+ */
+CO_SDO_abortCode_t CO_RPDOstageMap(
+        CO_RPDO_t              *RPDO,
+        const uint32_t          mappedObjects[],
+        uint8_t                 noOfMappedObjects);
+
+
+/**
+ * Stage new mapping of TPDO.
+ *
+ * The same as CO_RPDOstageMap(), but for TPDO. If synchronous TPDO is valid,
+ * shadow mapping becomes active after the next SYNC, before it is sent by
+ * CO_TPDO_process(). Event driven TPDO exchanges mapping in the next
+ * CO_TPDO_processMap() call, before CO_TPDOtimers_process() sends it, and it
+ * is sent with the new data layout as soon as inhibit time allows.
+ *
+ * @param TPDO This object.
+ * @param mappedObjects Mapped objects, the same as mappedObjectN in
+ * #CO_TPDOMapPar_t.
+ * @param noOfMappedObjects Number of mapped objects, 1 to 8.
+ *
+ * @return 0 on success, otherwise SDO abort code. Active mapping is then not
+ * changed. CO_SDO_AB_DATA_DEV_STATE, if mapping of other TPDO is staged.
+ */
+CO_SDO_abortCode_t CO_TPDOstageMap(
+        CO_TPDO_t              *TPDO,
+        const uint32_t          mappedObjects[],
+        uint8_t                 noOfMappedObjects);
+
+
 /**
  * Verify Change of State of the PDO.
  *
  * Function verifies if variable mapped to TPDO has changed its value. Verified
  * are only variables, which has set attribute _CO_ODA_TPDO_DETECT_COS_ in
- * #CO_SDO_OD_attributes_t.
+ * #CO_SDO_OD_attributes_t. Current data are compared with the last sent data
+ * as one 64 bit word. Variables with deadband (see #CO_TPDOdeadband_t) must
+ * also change by more than their delta.
  *
- * Function may be called by application just before CO_TPDO_process() function,
- * for example: `TPDOx->sendRequest = CO_TPDOisCOS(TPDOx); CO_TPDO_process(TPDOx, ....`
+ * Function may be called by application before CO_TPDOtimers_process(),
+ * for example: `if(CO_TPDOisCOS(TPDOx)) CO_TPDOrequestSend(TPDOx);`
  *
  * @param TPDO TPDO object.
  *
@@ -357,16 +947,42 @@ uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO);
  * Send TPDO message.
  *
  * Function prepares TPDO data from Object Dictionary variables. It should not
- * be called by application, it is called from CO_TPDO_process().
+ * be called by application, it is called from CO_TPDO_process() and
+ * CO_TPDOtimers_process(). MPDO carries single object, see
+ * #CO_PDO_MPDO_SAM.
  *
  *
  * @param TPDO TPDO object.
  *
- * @return Same as CO_CANsend().
+ * @return Same as CO_CANsend() or CO_ERROR_TX_BUSY, if mapped OD entry was
+ * being written. In that case nothing is sent and _sendRequest_ is set.
  */
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO);
 
 
+/**
+ * Send event driven TPDO immediately.
+ *
+ * Function may be called by application, after it changes mapped variables,
+ * from RPDO processing or from interrupt. It does not wait for the next
+ * CO_TPDOtimers_process() call. TPDO is sent, if it is valid, in NMT
+ * operational state, with transmission type 254 or 255 and inhibit time has
+ * expired. Time since previous CO_TPDOtimers_process() call is measured with
+ * CO_TIMER_TICKS(), so inhibit and event timers start from the moment of
+ * sending. If TPDO can not be sent now, _sendRequest_ is set and TPDO is
+ * sent later by CO_TPDOtimers_process(). CO_LOCK_PDO() is held only while
+ * timers are checked and updated, data are packed and sent without it.
+ *
+ * @param TPDO TPDO object.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO if sent, CO_ERROR_TX_OVERFLOW (see
+ * CO_CANsend()), CO_ERROR_TX_BUSY if mapped OD entry was being written (see
+ * CO_TPDOsend()) or CO_ERROR_TX_UNCONFIGURED if TPDO was not sent now. In all
+ * error cases _sendRequest_ is set.
+ */
+int16_t CO_TPDOsendNow(CO_TPDO_t *TPDO);
+
+
 /**
  * Process received PDO messages.
  *
@@ -381,22 +997,68 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas);
 
 
 /**
- * Process transmitting PDO messages.
+ * Request transmission of event driven TPDO.
+ *
+ * Function sets _sendRequest_ and schedules TPDO in the timer queue. TPDO is
+ * sent by the next CO_TPDOtimers_process(), after inhibit time expires. Function
+ * may be called from any context.
+ *
+ * @param TPDO TPDO object.
+ */
+void CO_TPDOrequestSend(CO_TPDO_t *TPDO);
+
+
+/**
+ * Process synchronous transmitting PDO messages.
  *
- * Function must be called cyclically in any NMT state. It prepares and sends
- * TPDO if necessary. If Change of State needs to be detected, function
- * CO_TPDOisCOS() must be called before.
+ * Function must be called cyclically in any NMT state. It sends synchronous
+ * TPDO, if necessary. Event driven TPDOs are sent by CO_TPDOtimers_process().
  *
  * @param TPDO This object.
  * @param SYNC SYNC object. Ignored if NULL.
  * @param syncWas True, if CANopen SYNC message was just received or transmitted.
- * @param timeDifference_us Time difference from previous function call in [microseconds].
  */
 void CO_TPDO_process(
         CO_TPDO_t              *TPDO,
         CO_SYNC_t              *SYNC,
-        bool_t                  syncWas,
-        uint32_t                timeDifference_us);
+        bool_t                  syncWas);
+
+
+/**
+ * Exchange staged mapping of event driven TPDO.
+ *
+ * Function must be called cyclically for valid event driven TPDOs before
+ * CO_TPDOtimers_process(), because they are not processed by
+ * CO_TPDO_process(). It returns immediately, if no mapping of this TPDO is
+ * staged, see CO_TPDOstageMap(). Synchronous TPDO exchanges mapping only if
+ * SYNC was just received.
+ *
+ * @param TPDO This object.
+ * @param syncWas True, if CANopen SYNC message was just received or transmitted.
+ */
+void CO_TPDO_processMap(CO_TPDO_t *TPDO, bool_t syncWas);
+
+
+/**
+ * Process timers of event driven TPDOs.
+ *
+ * Function must be called cyclically in any NMT state. Only TPDOs with expired
+ * inhibit or event timer or with pending _sendRequest_ are visited, so
+ * processing time does not depend on number of TPDOs. On transition to or from
+ * NMT operational state all event driven TPDOs are rescheduled. CO_LOCK_PDO()
+ * is held only while the timer queue is changed, TPDOs are sent without it.
+ *
+ * @param timers This object.
+ * @param timeDifference_us Time difference from previous function call in [microseconds].
+ * @param timerNext_us Return value - info to OS - time in [microseconds] until
+ * the earliest inhibit or event timer expires. Lowered only, ignored if NULL.
+ * Change of State is not predictable, so application must wake up the
+ * processing when it changes mapped variables.
+ */
+void CO_TPDOtimers_process(
+        CO_TPDOtimers_t        *timers,
+        uint32_t                timeDifference_us,
+        uint32_t               *timerNext_us);
 
 #ifdef __cplusplus
 }
@@ -222,8 +222,22 @@ static void CO_SDO_receive(void *object, const CO_CANrxMsg_t *msg){
 
                 SDO->sequence++;
 
+                /* streamed OD entry, copy data directly to its memory region.
+                 * Bytes beyond the region are counted, but not stored. */
+                if(SDO->stream != NULL) {
+                    uint32_t pos = SDO->streamOffset + SDO->bufferOffset;
+
+                    for(i=1; i<8; i++) {
+                        if(pos < SDO->stream->size) {
+                            SDO->stream->pData[pos] = msg->data[i];
+                        }
+                        pos++;
+                    }
+                    SDO->bufferOffset += 7U;
+                }
+
                 /* copy data */
-                for(i=1; i<8; i++) {
+                else for(i=1; i<8; i++) {
                     SDO->ODF_arg.data[SDO->bufferOffset++] = msg->data[i]; //SDO->ODF_arg.data is equal as SDO->databuffer
                     if(SDO->bufferOffset >= CO_SDO_BUFFER_SIZE) {
                         /* buffer full, break reception */
@@ -281,6 +295,202 @@ static CO_SDO_abortCode_t CO_ODF_1200(CO_ODF_arg_t *ODF_arg){
 }
 
 
+/*
+ * Fill page table for CO_OD_find(). Returns false, if page table can not be
+ * used, because OD is not ordered by index.
+ */
+static bool_t CO_OD_buildPages(
+        const CO_OD_entry_t     OD[],
+        uint16_t                ODSize,
+        uint16_t                ODPages[])
+{
+    uint16_t i, page;
+
+    if(ODPages == NULL){
+        return false;
+    }
+
+    page = 0U;
+    for(i=0U; i<ODSize; i++){
+        uint16_t hi = OD[i].index >> 8;
+
+        if((i > 0U) && (OD[i].index <= OD[i-1U].index)){
+            return false;
+        }
+        while(page <= hi){
+            ODPages[page++] = i;
+        }
+    }
+    while(page < CO_OD_PAGE_TABLE_SIZE){
+        ODPages[page++] = ODSize;
+    }
+
+    return true;
+}
+
+
+/*
+ * Decode length, attribute and data pointer of the sub-index from OD entry.
+ * Used to build descriptors and if descriptors are not available.
+ */
+static uint16_t CO_OD_decodeLength(const CO_OD_entry_t* object, uint8_t subIndex){
+    if(object->maxSubIndex == 0U){    /* Object type is Var */
+        if(object->pData == 0){ /* data type is domain */
+            return CO_SDO_BUFFER_SIZE;
+        }
+        else{
+            return object->length;
+        }
+    }
+    else if(object->attribute != 0U){ /* Object type is Array */
+        if(subIndex == 0U){
+            return 1U;
+        }
+        else if(object->pData == 0){
+            /* data type is domain */
+            return CO_SDO_BUFFER_SIZE;
+        }
+        else{
+            return object->length;
+        }
+    }
+    else{                            /* Object type is Record */
+        if(((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData == 0){
+            /* data type is domain */
+            return CO_SDO_BUFFER_SIZE;
+        }
+        else{
+            return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].length;
+        }
+    }
+}
+
+static uint16_t CO_OD_decodeAttribute(const CO_OD_entry_t* object, uint8_t subIndex){
+    if(object->maxSubIndex == 0U){   /* Object type is Var */
+        return object->attribute;
+    }
+    else if(object->attribute != 0U){/* Object type is Array */
+        bool_t exception_1003 = false;
+        uint16_t attr = object->attribute;
+
+        /* Special exception: Object 1003,00 should be writable */
+        if(object->index == 0x1003 && subIndex == 0) {
+            exception_1003 = true;
+            attr |= CO_ODA_WRITEABLE;
+        }
+
+        if(subIndex == 0U  && exception_1003 == false){
+            /* First subIndex is readonly, it is number of elements */
+            attr &= ~(CO_ODA_WRITEABLE | CO_ODA_RPDO_MAPABLE | CO_ODA_SIGNED);
+            attr |= CO_ODA_READABLE;
+        }
+        return attr;
+    }
+    else{                            /* Object type is Record */
+        return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].attribute;
+    }
+}
+
+static void* CO_OD_decodeDataPointer(const CO_OD_entry_t* object, uint8_t subIndex){
+    if(object->maxSubIndex == 0U){   /* Object type is Var */
+        return object->pData;
+    }
+    else if(object->attribute != 0U){/* Object type is Array */
+        if(subIndex==0){
+            /* this is the data, for the subIndex 0 in the array */
+            return (void*) &object->maxSubIndex;
+        }
+        else if(object->pData == 0){
+            /* data type is domain */
+            return 0;
+        }
+        else{
+            return (void*)(((int8_t*)object->pData) + ((subIndex-1) * object->length));
+        }
+    }
+    else{                            /* Object Type is Record */
+        return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData;
+    }
+}
+
+
+/*
+ * Fill descriptors of all sub-indexes and assign their offsets to ODInfo.
+ * Return false, if array is too small and descriptors can not be used.
+ */
+static bool_t CO_OD_buildDescriptors(
+        CO_SDO_t               *SDO,
+        CO_OD_descriptor_t      ODDescriptors[],
+        uint16_t                ODDescriptorsSize)
+{
+    uint32_t count = 0U;
+    uint16_t offset = 0U;
+    uint16_t i;
+
+    if((ODDescriptors == NULL) || (SDO->ODInfo == NULL)){
+        return false;
+    }
+    for(i=0U; i<SDO->ODSize; i++){
+        count += (uint32_t)SDO->OD[i].maxSubIndex + 1U;
+    }
+    if(count > ODDescriptorsSize){
+        return false;
+    }
+
+    for(i=0U; i<SDO->ODSize; i++){
+        const CO_OD_entry_t* object = &SDO->OD[i];
+        uint16_t sub;
+
+        SDO->ODInfo[i].descriptor = offset;
+        for(sub=0U; sub<=object->maxSubIndex; sub++){
+            CO_OD_descriptor_t *desc = &ODDescriptors[offset++];
+
+            desc->pData = CO_OD_decodeDataPointer(object, (uint8_t)sub);
+            desc->length = CO_OD_decodeLength(object, (uint8_t)sub);
+            desc->attribute = CO_OD_decodeAttribute(object, (uint8_t)sub);
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Find extension of OD entry in hash table. If insert is true and extension
+ * does not exist, new one is created in the first free element. Return NULL,
+ * if extension does not exist or if hash table is full.
+ */
+static CO_OD_extension_t* CO_OD_findExtension(CO_SDO_t *SDO, uint16_t entryNo, bool_t insert){
+    uint16_t i, n;
+
+    if((SDO->ODExtensions == NULL) || (entryNo >= SDO->ODSize)){
+        return NULL;
+    }
+
+    i = entryNo % SDO->ODExtensionsSize;
+    for(n=SDO->ODExtensionsSize; n>0U; n--){
+        CO_OD_extension_t *ext = &SDO->ODExtensions[i];
+
+        if(ext->entryNo == entryNo){
+            return ext;
+        }
+        if(ext->entryNo == 0xFFFFU){
+            if(!insert){
+                return NULL;
+            }
+            ext->entryNo = entryNo;
+            SDO->ODExtensionsUsed++;
+            return ext;
+        }
+        if(++i == SDO->ODExtensionsSize){
+            i = 0U;
+        }
+    }
+
+    return NULL;
+}
+
+
 /******************************************************************************/
 CO_ReturnError_t CO_SDO_init(
         CO_SDO_t               *SDO,
@@ -291,6 +501,13 @@ CO_ReturnError_t CO_SDO_init(
         const CO_OD_entry_t     OD[],
         uint16_t                ODSize,
         CO_OD_extension_t      *ODExtensions,
+        uint16_t                ODExtensionsSize,
+        CO_OD_entryInfo_t       ODInfo[],
+        uint16_t                ODPages[],
+        CO_OD_descriptor_t      ODDescriptors[],
+        uint16_t                ODDescriptorsSize,
+        uint32_t                ODDirty[],
+        uint32_t                ODTPDOMap[],
         uint8_t                 nodeId,
         CO_CANmodule_t         *CANdevRx,
         uint16_t                CANdevRxIdx,
@@ -307,15 +524,54 @@ CO_ReturnError_t CO_SDO_init(
         uint16_t i;
 
         SDO->ownOD = true;
-        SDO->OD = OD;
-        SDO->ODSize = ODSize;
-        SDO->ODExtensions = ODExtensions;
 
-        /* clear pointers in ODExtensions */
-        for(i=0U; i<ODSize; i++){
-            SDO->ODExtensions[i].pODFunc = NULL;
-            SDO->ODExtensions[i].object = NULL;
-            SDO->ODExtensions[i].flags = NULL;
+        /* OD is NULL by fast communication reset: keep the object dictionary,
+         * its tables and extensions from the previous initialization. */
+        if(OD != NULL){
+            SDO->OD = OD;
+            SDO->ODSize = ODSize;
+            SDO->ODExtensions = (ODExtensionsSize != 0U) ? ODExtensions : NULL;
+            SDO->ODExtensionsSize = ODExtensionsSize;
+            SDO->ODInfo = ODInfo;
+
+            /* clear hash table of extensions */
+            SDO->ODExtensionsUsed = 0U;
+            if(SDO->ODExtensions != NULL){
+                for(i=0U; i<ODExtensionsSize; i++){
+                    SDO->ODExtensions[i].entryNo = 0xFFFFU;
+                    SDO->ODExtensions[i].pODFunc = NULL;
+                    SDO->ODExtensions[i].object = NULL;
+                    SDO->ODExtensions[i].flags = NULL;
+                    SDO->ODExtensions[i].stream = NULL;
+                }
+            }
+
+            /* clear sequence counters */
+            if(SDO->ODInfo != NULL){
+                for(i=0U; i<ODSize; i++){
+                    SDO->ODInfo[i].seq = 0U;
+                }
+            }
+
+            /* descriptors and page table, may be NULL and built later */
+            SDO->ODDescriptors = NULL;
+            SDO->ODPages = NULL;
+            CO_OD_buildTables(SDO, ODPages, ODDescriptors, ODDescriptorsSize);
+
+            SDO->ODDirty = (ODTPDOMap != NULL) ? ODDirty : NULL;
+            SDO->ODTPDOMap = ODTPDOMap;
+        }
+
+        /* mark all entries as changed, so TPDOs verify initial values.
+         * Reverse index is filled by TPDOs. */
+        if(SDO->ODDirty != NULL){
+            for(i=0U; i<CO_OD_DIRTY_SIZE(SDO->ODSize); i++){
+                SDO->ODDirty[i] = 0U;
+            }
+            for(i=0U; i<SDO->ODSize; i++){
+                SDO->ODDirty[i >> 5] |= 1UL << (i & 0x1FU);
+                SDO->ODTPDOMap[i] = 0U;
+            }
         }
     }
     /* copy object dictionary from parent */
@@ -324,13 +580,23 @@ CO_ReturnError_t CO_SDO_init(
         SDO->OD = parentSDO->OD;
         SDO->ODSize = parentSDO->ODSize;
         SDO->ODExtensions = parentSDO->ODExtensions;
+        SDO->ODExtensionsSize = parentSDO->ODExtensionsSize;
+        SDO->ODExtensionsUsed = parentSDO->ODExtensionsUsed;
+        SDO->ODInfo = parentSDO->ODInfo;
+        SDO->ODDescriptors = parentSDO->ODDescriptors;
+        SDO->ODPages = parentSDO->ODPages;
+        SDO->ODDirty = parentSDO->ODDirty;
+        SDO->ODTPDOMap = parentSDO->ODTPDOMap;
     }
 
     /* Configure object variables */
     SDO->nodeId = nodeId;
     SDO->state = CO_SDO_ST_IDLE;
     SDO->CANrxNew = false;
+    SDO->PDOchanged = false;
     SDO->pFunctSignal = NULL;
+    SDO->extension = NULL;
+    SDO->stream = NULL;
 
 
     /* Configure Object dictionary entry at index 0x1200 */
@@ -367,6 +633,26 @@ CO_ReturnError_t CO_SDO_init(
 }
 
 
+/******************************************************************************/
+void CO_OD_buildTables(
+        CO_SDO_t               *SDO,
+        uint16_t                ODPages[],
+        CO_OD_descriptor_t      ODDescriptors[],
+        uint16_t                ODDescriptorsSize)
+{
+    /* tables are used only after they are complete */
+    if((SDO->ODDescriptors == NULL) && CO_OD_buildDescriptors(SDO, ODDescriptors, ODDescriptorsSize)){
+        CO_MEMORY_BARRIER();
+        SDO->ODDescriptors = ODDescriptors;
+    }
+
+    if((SDO->ODPages == NULL) && CO_OD_buildPages(SDO->OD, SDO->ODSize, ODPages)){
+        CO_MEMORY_BARRIER();
+        SDO->ODPages = ODPages;
+    }
+}
+
+
 /******************************************************************************/
 void CO_SDO_initCallback(
         CO_SDO_t               *SDO,
@@ -379,7 +665,7 @@ void CO_SDO_initCallback(
 
 
 /******************************************************************************/
-void CO_OD_configure(
+CO_ReturnError_t CO_OD_configure(
         CO_SDO_t               *SDO,
         uint16_t                index,
         CO_SDO_abortCode_t    (*pODFunc)(CO_ODF_arg_t *ODF_arg),
@@ -391,9 +677,13 @@ void CO_OD_configure(
 
     entryNo = CO_OD_find(SDO, index);
     if(entryNo < 0xFFFFU){
-        CO_OD_extension_t *ext = &SDO->ODExtensions[entryNo];
+        CO_OD_extension_t *ext = CO_OD_findExtension(SDO, entryNo, true);
         uint8_t maxSubIndex = SDO->OD[entryNo].maxSubIndex;
 
+        if(ext == NULL){
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+
         ext->pODFunc = pODFunc;
         ext->object = object;
         if((flags != NULL) && (flagsSize != 0U) && (flagsSize == maxSubIndex)){
@@ -407,6 +697,30 @@ void CO_OD_configure(
             ext->flags = NULL;
         }
     }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_OD_configureStream(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        CO_SDO_stream_t        *stream)
+{
+    uint16_t entryNo;
+
+    entryNo = CO_OD_find(SDO, index);
+    if(entryNo < 0xFFFFU){
+        CO_OD_extension_t *ext = CO_OD_findExtension(SDO, entryNo, true);
+
+        if(ext == NULL){
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+        ext->stream = stream;
+    }
+
+    return CO_ERROR_NO;
 }
 
 
@@ -417,8 +731,28 @@ uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index){
     uint16_t cur, min, max;
     const CO_OD_entry_t* object;
 
-    min = 0U;
-    max = SDO->ODSize - 1U;
+    if(SDO->ODPages != NULL){
+        /* limit search to the page with the same index high byte */
+        uint16_t hi = index >> 8;
+
+        min = SDO->ODPages[hi];
+        max = SDO->ODPages[hi + 1U];
+        if(min == max){
+            return 0xFFFFU;  /* page is empty */
+        }
+
+        /* guess position, exact if indexes in page are consecutive */
+        cur = min + ((index & 0xFFU) - (SDO->OD[min].index & 0xFFU));
+        if((cur >= min) && (cur < max) && (SDO->OD[cur].index == index)){
+            return cur;
+        }
+        max--;
+    }
+    else{
+        min = 0U;
+        max = SDO->ODSize - 1U;
+    }
+
     while(min < max){
         cur = (min + max) / 2;
         object = &SDO->OD[cur];
@@ -446,132 +780,195 @@ uint16_t CO_OD_find(CO_SDO_t *SDO, uint16_t index){
 }
 
 
+/*
+ * Return precomputed descriptor or NULL, if not available for this sub-index.
+ */
+static const CO_OD_descriptor_t* CO_OD_descriptor(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
+    if((SDO->ODDescriptors == NULL) || (subIndex > SDO->OD[entryNo].maxSubIndex)){
+        return NULL;
+    }
+
+    return &SDO->ODDescriptors[SDO->ODInfo[entryNo].descriptor + subIndex];
+}
+
+
 /******************************************************************************/
 uint16_t CO_OD_getLength(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
-    const CO_OD_entry_t* object = &SDO->OD[entryNo];
+    const CO_OD_descriptor_t *desc;
 
     if(entryNo == 0xFFFFU){
         return 0U;
     }
 
-    if(object->maxSubIndex == 0U){    /* Object type is Var */
-        if(object->pData == 0){ /* data type is domain */
-            return CO_SDO_BUFFER_SIZE;
-        }
-        else{
-            return object->length;
-        }
-    }
-    else if(object->attribute != 0U){ /* Object type is Array */
-        if(subIndex == 0U){
-            return 1U;
-        }
-        else if(object->pData == 0){
-            /* data type is domain */
-            return CO_SDO_BUFFER_SIZE;
-        }
-        else{
-            return object->length;
-        }
-    }
-    else{                            /* Object type is Record */
-        if(((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData == 0){
-            /* data type is domain */
-            return CO_SDO_BUFFER_SIZE;
-        }
-        else{
-            return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].length;
-        }
-    }
+    desc = CO_OD_descriptor(SDO, entryNo, subIndex);
+    return (desc != NULL) ? desc->length : CO_OD_decodeLength(&SDO->OD[entryNo], subIndex);
 }
 
 
 /******************************************************************************/
 uint16_t CO_OD_getAttribute(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
-    const CO_OD_entry_t* object = &SDO->OD[entryNo];
+    const CO_OD_descriptor_t *desc;
 
     if(entryNo == 0xFFFFU){
         return 0U;
     }
 
-    if(object->maxSubIndex == 0U){   /* Object type is Var */
-        return object->attribute;
+    desc = CO_OD_descriptor(SDO, entryNo, subIndex);
+    return (desc != NULL) ? desc->attribute : CO_OD_decodeAttribute(&SDO->OD[entryNo], subIndex);
+}
+
+
+/******************************************************************************/
+void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
+    const CO_OD_descriptor_t *desc;
+
+    if(entryNo == 0xFFFFU){
+        return 0;
     }
-    else if(object->attribute != 0U){/* Object type is Array */
-        bool_t exception_1003 = false;
-        uint16_t attr = object->attribute;
 
-        /* Special exception: Object 1003,00 should be writable */
-        if(object->index == 0x1003 && subIndex == 0) {
-            exception_1003 = true;
-            attr |= CO_ODA_WRITEABLE;
-        }
+    desc = CO_OD_descriptor(SDO, entryNo, subIndex);
+    return (desc != NULL) ? desc->pData : CO_OD_decodeDataPointer(&SDO->OD[entryNo], subIndex);
+}
 
-        if(subIndex == 0U  && exception_1003 == false){
-            /* First subIndex is readonly */
-            attr &= ~(CO_ODA_WRITEABLE | CO_ODA_RPDO_MAPABLE);
-            attr |= CO_ODA_READABLE;
-        }
-        return attr;
+
+/******************************************************************************/
+uint8_t* CO_OD_getFlagsPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
+    CO_OD_extension_t* ext = CO_OD_findExtension(SDO, entryNo, false);
+
+    if((ext == NULL) || (ext->flags == NULL)){
+        return 0;
     }
-    else{                            /* Object type is Record */
-        return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].attribute;
+
+    return &ext->flags[subIndex];
+}
+
+
+/******************************************************************************/
+CO_OD_extension_t* CO_OD_getExtension(CO_SDO_t *SDO, uint16_t entryNo){
+    return CO_OD_findExtension(SDO, entryNo, false);
+}
+
+
+/******************************************************************************/
+void CO_OD_getDescriptor(
+        CO_SDO_t               *SDO,
+        uint16_t                entryNo,
+        uint8_t                 subIndex,
+        CO_OD_descriptor_t     *desc)
+{
+    const CO_OD_descriptor_t *d = CO_OD_descriptor(SDO, entryNo, subIndex);
+
+    if(d != NULL){
+        *desc = *d;
+    }
+    else{
+        const CO_OD_entry_t* object = &SDO->OD[entryNo];
+
+        desc->pData = CO_OD_decodeDataPointer(object, subIndex);
+        desc->length = CO_OD_decodeLength(object, subIndex);
+        desc->attribute = CO_OD_decodeAttribute(object, subIndex);
     }
 }
 
 
 /******************************************************************************/
-void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
-    const CO_OD_entry_t* object = &SDO->OD[entryNo];
+void CO_OD_markDirty(CO_SDO_t *SDO, uint16_t entryNo){
+    if((SDO->ODDirty != NULL) && (entryNo < SDO->ODSize)){
+        CO_LOCK_OD();
+        SDO->ODDirty[entryNo >> 5] |= 1UL << (entryNo & 0x1FU);
+        CO_UNLOCK_OD();
+    }
+}
 
-    if(entryNo == 0xFFFFU){
-        return 0;
+
+/******************************************************************************/
+void CO_OD_writeBegin(CO_SDO_t *SDO, uint16_t entryNo){
+    if(SDO->ODInfo != NULL){
+        CO_LOCK_OD();
+        SDO->ODInfo[entryNo].seq++;
+        CO_UNLOCK_OD();
+        CO_MEMORY_BARRIER();
     }
+}
 
-    if(object->maxSubIndex == 0U){   /* Object type is Var */
-        return object->pData;
+
+/******************************************************************************/
+void CO_OD_writeEnd(CO_SDO_t *SDO, uint16_t entryNo){
+    CO_MEMORY_BARRIER();
+    if(SDO->ODInfo != NULL){
+        CO_LOCK_OD();
+        SDO->ODInfo[entryNo].seq++;
+        CO_UNLOCK_OD();
     }
-    else if(object->attribute != 0U){/* Object type is Array */
-        if(subIndex==0){
-            /* this is the data, for the subIndex 0 in the array */
-            return (void*) &object->maxSubIndex;
-        }
-        else if(object->pData == 0){
-            /* data type is domain */
-            return 0;
-        }
-        else{
-            return (void*)(((int8_t*)object->pData) + ((subIndex-1) * object->length));
-        }
+    CO_OD_markDirty(SDO, entryNo);
+}
+
+
+/******************************************************************************/
+uint16_t CO_OD_readBegin(CO_SDO_t *SDO, uint16_t entryNo){
+    uint16_t seq = 0U;
+
+    if(SDO->ODInfo != NULL){
+        seq = SDO->ODInfo[entryNo].seq;
     }
-    else{                            /* Object Type is Record */
-        return ((const CO_OD_entryRecord_t*)(object->pData))[subIndex].pData;
+    CO_MEMORY_BARRIER();
+
+    return seq;
+}
+
+
+/******************************************************************************/
+bool_t CO_OD_readRetry(CO_SDO_t *SDO, uint16_t entryNo, uint16_t seq){
+    CO_MEMORY_BARRIER();
+    if(SDO->ODInfo == NULL){
+        return false;
     }
+
+    return ((seq & 1U) != 0U) || (SDO->ODInfo[entryNo].seq != seq);
 }
 
 
 /******************************************************************************/
-uint8_t* CO_OD_getFlagsPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex){
-    CO_OD_extension_t* ext;
+uint32_t CO_OD_getChangedTPDOs(CO_SDO_t *SDO){
+    uint32_t TPDOs = 0U;
+    uint16_t i;
 
-    if((entryNo == 0xFFFFU) || (SDO->ODExtensions == 0)){
-        return 0;
+    if(SDO->ODDirty == NULL){
+        return 0xFFFFFFFFUL;
     }
 
-    ext = &SDO->ODExtensions[entryNo];
+    for(i=0U; i<CO_OD_DIRTY_SIZE(SDO->ODSize); i++){
+        uint16_t entryNo = i << 5;
+        uint32_t dirty;
 
-    return &ext->flags[subIndex];
+        CO_LOCK_OD();
+        dirty = SDO->ODDirty[i];
+        SDO->ODDirty[i] = 0U;
+        CO_UNLOCK_OD();
+
+        for(; dirty != 0U; dirty >>= 1){
+            if((dirty & 1U) != 0U){
+                TPDOs |= SDO->ODTPDOMap[entryNo];
+            }
+            entryNo++;
+        }
+    }
+
+    return TPDOs;
 }
 
 
 /******************************************************************************/
 uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
+    CO_OD_descriptor_t desc;
 
     SDO->ODF_arg.index = index;
     SDO->ODF_arg.subIndex = subIndex;
+    SDO->stream = NULL;
 
     /* find object in Object Dictionary */
     SDO->entryNo = CO_OD_find(SDO, index);
+    SDO->extension = CO_OD_findExtension(SDO, SDO->entryNo, false);
     if(SDO->entryNo == 0xFFFFU){
         return CO_SDO_AB_NOT_EXIST ;     /* object does not exist in OD */
     }
@@ -583,18 +980,18 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
         return CO_SDO_AB_SUB_UNKNOWN;     /* Sub-index does not exist. */
     }
 
-    /* pointer to data in Object dictionary */
-    SDO->ODF_arg.ODdataStorage = CO_OD_getDataPointer(SDO, SDO->entryNo, subIndex);
+    /* pointer to data in Object dictionary, length and attribute */
+    CO_OD_getDescriptor(SDO, SDO->entryNo, subIndex, &desc);
+    SDO->ODF_arg.ODdataStorage = desc.pData;
 
     /* fill ODF_arg */
     SDO->ODF_arg.object = NULL;
-    if(SDO->ODExtensions){
-        CO_OD_extension_t *ext = &SDO->ODExtensions[SDO->entryNo];
-        SDO->ODF_arg.object = ext->object;
+    if(SDO->extension != NULL){
+        SDO->ODF_arg.object = SDO->extension->object;
     }
     SDO->ODF_arg.data = SDO->databuffer;
-    SDO->ODF_arg.dataLength = CO_OD_getLength(SDO, SDO->entryNo, subIndex);
-    SDO->ODF_arg.attribute = CO_OD_getAttribute(SDO, SDO->entryNo, subIndex);
+    SDO->ODF_arg.dataLength = desc.length;
+    SDO->ODF_arg.attribute = desc.attribute;
     SDO->ODF_arg.pFlags = CO_OD_getFlagsPointer(SDO, SDO->entryNo, subIndex);
 
     SDO->ODF_arg.firstSegment = true;
@@ -605,6 +1002,17 @@ uint32_t CO_SDO_initTransfer(CO_SDO_t *SDO, uint16_t index, uint8_t subIndex){
 
     SDO->ODF_arg.offset = 0U;
 
+    /* streamed sub-index is transferred directly from/to its memory region */
+    if(SDO->extension != NULL){
+        CO_SDO_stream_t *stream = SDO->extension->stream;
+        if((stream != NULL) && (stream->subIndex == subIndex)){
+            SDO->stream = stream;
+            SDO->streamOffset = 0U;
+            SDO->ODF_arg.dataLengthTotal = stream->dataLength;
+            return 0U;
+        }
+    }
+
     /* verify length */
     if(SDO->ODF_arg.dataLength > CO_SDO_BUFFER_SIZE){
         return CO_SDO_AB_DEVICE_INCOMPAT;     /* general internal incompatibility in the device */
@@ -619,33 +1027,36 @@ uint32_t CO_SDO_readOD(CO_SDO_t *SDO, uint16_t SDOBufferSize){
     uint8_t *SDObuffer = SDO->ODF_arg.data;
     uint8_t *ODdata = (uint8_t*)SDO->ODF_arg.ODdataStorage;
     uint16_t length = SDO->ODF_arg.dataLength;
-    CO_OD_extension_t *ext = 0;
+    CO_OD_extension_t *ext = SDO->extension;
 
     /* is object readable? */
     if((SDO->ODF_arg.attribute & CO_ODA_READABLE) == 0)
         return CO_SDO_AB_WRITEONLY;     /* attempt to read a write-only object */
 
-    /* find extension */
-    if(SDO->ODExtensions != NULL){
-        ext = &SDO->ODExtensions[SDO->entryNo];
-    }
-
-    /* copy data from OD to SDO buffer if not domain */
+    /* copy data from OD to SDO buffer if not domain. Copy again, if PDO
+     * has written the entry meanwhile. */
     if(ODdata != NULL){
-        CO_LOCK_OD();
-        while(length--) *(SDObuffer++) = *(ODdata++);
-        CO_UNLOCK_OD();
+        uint16_t seq;
+
+        do{
+            uint8_t *dst = SDObuffer;
+            uint8_t *src = ODdata;
+            uint16_t len = length;
+
+            seq = CO_OD_readBegin(SDO, SDO->entryNo);
+            while(len--) *(dst++) = *(src++);
+        }while(CO_OD_readRetry(SDO, SDO->entryNo, seq));
     }
     /* if domain, Object dictionary function MUST exist */
     else{
-        if(ext->pODFunc == NULL){
+        if((ext == NULL) || (ext->pODFunc == NULL)){
             return CO_SDO_AB_DEVICE_INCOMPAT;     /* general internal incompatibility in the device */
         }
     }
 
     /* call Object dictionary function if registered */
     SDO->ODF_arg.reading = true;
-    if(ext->pODFunc != NULL){
+    if((ext != NULL) && (ext->pODFunc != NULL)){
         uint32_t abortCode = ext->pODFunc(&SDO->ODF_arg);
         if(abortCode != 0U){
             return abortCode;
@@ -718,8 +1129,8 @@ uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length){
 
     /* call Object dictionary function if registered */
     SDO->ODF_arg.reading = false;
-    if(SDO->ODExtensions != NULL){
-        CO_OD_extension_t *ext = &SDO->ODExtensions[SDO->entryNo];
+    if(SDO->extension != NULL){
+        CO_OD_extension_t *ext = SDO->extension;
 
         if(ext->pODFunc != NULL){
             uint32_t abortCode = ext->pODFunc(&SDO->ODF_arg);
@@ -738,19 +1149,53 @@ uint32_t CO_SDO_writeOD(CO_SDO_t *SDO, uint16_t length){
 
     /* copy data from SDO buffer to OD if not domain */
     if(ODdata != NULL && exception_1003 == false){
-        CO_LOCK_OD();
+        CO_OD_writeBegin(SDO, SDO->entryNo);
         while(length--){
             *(ODdata++) = *(SDObuffer++);
         }
-        CO_UNLOCK_OD();
+        CO_OD_writeEnd(SDO, SDO->entryNo);
+    }
+
+    /* real time context must take the change into account without delay */
+    if((SDO->ODF_arg.index >= 0x1005 && SDO->ODF_arg.index <= 0x1007) ||
+       (SDO->ODF_arg.index >= 0x1800 && SDO->ODF_arg.index <= 0x1BFF) ||
+        SDO->ODTPDOMap == NULL || SDO->ODTPDOMap[SDO->entryNo] != 0U)
+    {
+        SDO->PDOchanged = true;
     }
 
     return 0;
 }
 
 
+/*
+ * Finish transfer of streamed OD entry. After download, commit or roll back
+ * the data with pFunctCommit. Returns abort code from pFunctCommit on commit.
+ */
+static uint32_t CO_SDO_streamEnd(CO_SDO_t *SDO, bool_t commit){
+    CO_SDO_stream_t *stream = SDO->stream;
+    uint32_t abortCode = 0U;
+
+    SDO->stream = NULL;
+    if((stream != NULL) && (!SDO->ODF_arg.reading)){
+        if(stream->pFunctCommit != NULL){
+            abortCode = stream->pFunctCommit(stream->object, commit, SDO->streamOffset);
+        }
+        if(!commit){
+            abortCode = 0U;
+        }
+        else if(abortCode == 0U){
+            stream->dataLength = SDO->streamOffset;
+        }
+    }
+
+    return abortCode;
+}
+
+
 /******************************************************************************/
 static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
+    CO_SDO_streamEnd(SDO, false);
     SDO->CANtxBuff->data[0] = 0x80;
     SDO->CANtxBuff->data[1] = SDO->ODF_arg.index & 0xFF;
     SDO->CANtxBuff->data[2] = (SDO->ODF_arg.index>>8) & 0xFF;
@@ -762,6 +1207,52 @@ static void CO_SDO_abort(CO_SDO_t *SDO, uint32_t code){
 }
 
 
+/*
+ * Read next data of domain from Object dictionary function into free part of
+ * the block upload ring buffer. Free part may wrap around the end of the
+ * databuffer, so Object dictionary function is called once for each
+ * contiguous free region. On return ODF_arg.data points to databuffer and
+ * ODF_arg.dataLength is number of valid bytes from bufferStart on. Sub-block
+ * must fit into the ring, see #CO_SDO_BUFFER_SIZE.
+ */
+static uint32_t CO_SDO_uploadFillRing(CO_SDO_t *SDO){
+    uint16_t used = SDO->ODF_arg.dataLength;
+    uint32_t abortCode = 0U;
+    uint8_t n;
+
+    for(n=0U; (n<2U) && (!SDO->ODF_arg.lastSegment) && (used < CO_SDO_BUFFER_SIZE); n++){
+        uint16_t wr = SDO->bufferStart + used;
+        uint16_t space;
+
+        if(wr >= CO_SDO_BUFFER_SIZE){
+            wr -= CO_SDO_BUFFER_SIZE;
+            space = SDO->bufferStart - wr;
+        }
+        else{
+            space = CO_SDO_BUFFER_SIZE - wr;
+        }
+
+        SDO->ODF_arg.data = &SDO->databuffer[wr];
+        SDO->ODF_arg.dataLength = space;
+        abortCode = CO_SDO_readOD(SDO, space);
+        if(abortCode != 0U){
+            break;
+        }
+
+        /* calculate CRC on next bytes, if enabled */
+        if(SDO->crcEnabled){
+            SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, SDO->crc);
+        }
+        used += SDO->ODF_arg.dataLength;
+    }
+
+    SDO->ODF_arg.data = SDO->databuffer;
+    SDO->ODF_arg.dataLength = used;
+
+    return abortCode;
+}
+
+
 /******************************************************************************/
 int8_t CO_SDO_process(
         CO_SDO_t               *SDO,
@@ -781,6 +1272,7 @@ int8_t CO_SDO_process(
 
     /* SDO is allowed to work only in operational or pre-operational NMT state */
     if(!NMTisPreOrOperational){
+        CO_SDO_streamEnd(SDO, false);
         SDO->state = CO_SDO_ST_IDLE;
         SDO->CANrxNew = false;
         return 0;
@@ -800,6 +1292,7 @@ int8_t CO_SDO_process(
 
         /* Is abort from client? */
         if((SDO->CANrxNew) && (SDO->CANrxData[0] == CCS_ABORT)){
+            CO_SDO_streamEnd(SDO, false);
             SDO->state = CO_SDO_ST_IDLE;
             SDO->CANrxNew = false;
             return -1;
@@ -835,6 +1328,7 @@ int8_t CO_SDO_process(
                     CO_SDO_abort(SDO, CO_SDO_AB_READONLY); /* attempt to write a read-only object */
                     return -1;
                 }
+                SDO->ODF_arg.reading = false;
 
                 /* set state machine to normal or block download */
                 if(CCS == CCS_DOWNLOAD_INITIATE){
@@ -847,14 +1341,28 @@ int8_t CO_SDO_process(
 
             /* upload */
             else{
-                abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
-                if(abortCode != 0U){
-                    CO_SDO_abort(SDO, abortCode);
-                    return -1;
+                uint32_t uploadLength;
+
+                if(SDO->stream != NULL){
+                    /* streamed data is read directly from its memory region */
+                    SDO->ODF_arg.reading = true;
+                    if((SDO->ODF_arg.attribute & CO_ODA_READABLE) == 0U){
+                        CO_SDO_abort(SDO, CO_SDO_AB_WRITEONLY); /* attempt to read a write-only object */
+                        return -1;
+                    }
+                    uploadLength = SDO->stream->dataLength;
+                }
+                else{
+                    abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
+                    if(abortCode != 0U){
+                        CO_SDO_abort(SDO, abortCode);
+                        return -1;
+                    }
+                    uploadLength = SDO->ODF_arg.dataLength;
                 }
 
                 /* if data size is large enough set state machine to block upload, otherwise set to normal transfer */
-                if((CCS == CCS_UPLOAD_BLOCK) && (SDO->ODF_arg.dataLength > SDO->CANrxData[5])){
+                if((CCS == CCS_UPLOAD_BLOCK) && (uploadLength > SDO->CANrxData[5])){
                     state = CO_SDO_ST_UPLOAD_BL_INITIATE;
                 }
                 else{
@@ -879,6 +1387,14 @@ int8_t CO_SDO_process(
         }
     }
 
+    /* Calculate, when SDO timeout expires and lower timerNext_ms if necessary. */
+    if(timerNext_ms != NULL && SDO->timeoutTimer < SDOtimeoutTime){
+        uint16_t diff = SDOtimeoutTime - SDO->timeoutTimer;
+        if(*timerNext_ms > diff){
+            *timerNext_ms = diff;
+        }
+    }
+
     /* return immediately if still idle */
     if(state == CO_SDO_ST_IDLE){
         return 0;
@@ -907,14 +1423,27 @@ int8_t CO_SDO_process(
                     len = SDO->ODF_arg.dataLength;
                 }
 
-                /* copy data to SDO buffer */
-                SDO->ODF_arg.data[0] = SDO->CANrxData[4];
-                SDO->ODF_arg.data[1] = SDO->CANrxData[5];
-                SDO->ODF_arg.data[2] = SDO->CANrxData[6];
-                SDO->ODF_arg.data[3] = SDO->CANrxData[7];
-
-                /* write data to the Object dictionary */
-                abortCode = CO_SDO_writeOD(SDO, len);
+                /* streamed OD entry, copy data directly and commit */
+                if(SDO->stream != NULL){
+                    if(len > SDO->stream->size){
+                        CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                        return -1;
+                    }
+                    for(i=0U; i<len; i++)
+                        SDO->stream->pData[i] = SDO->CANrxData[4U+i];
+                    SDO->streamOffset = len;
+                    abortCode = CO_SDO_streamEnd(SDO, true);
+                }
+                else{
+                    /* copy data to SDO buffer */
+                    SDO->ODF_arg.data[0] = SDO->CANrxData[4];
+                    SDO->ODF_arg.data[1] = SDO->CANrxData[5];
+                    SDO->ODF_arg.data[2] = SDO->CANrxData[6];
+                    SDO->ODF_arg.data[3] = SDO->CANrxData[7];
+
+                    /* write data to the Object dictionary */
+                    abortCode = CO_SDO_writeOD(SDO, len);
+                }
                 if(abortCode != 0U){
                     CO_SDO_abort(SDO, abortCode);
                     return -1;
@@ -933,8 +1462,14 @@ int8_t CO_SDO_process(
                     CO_memcpySwap4(&lenRx, &SDO->CANrxData[4]);
                     SDO->ODF_arg.dataLengthTotal = lenRx;
 
-                    /* verify length except for domain data type */
-                    if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
+                    /* verify length except for domain data type and streamed entry */
+                    if(SDO->stream != NULL){
+                        if(lenRx > SDO->stream->size){
+                            CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                            return -1;
+                        }
+                    }
+                    else if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
                         CO_SDO_abort(SDO, CO_SDO_AB_TYPE_MISMATCH);  /* Length of service parameter does not match */
                         return -1;
                     }
@@ -964,8 +1499,16 @@ int8_t CO_SDO_process(
             /* get size of data in message */
             len = 7U - ((SDO->CANrxData[0] >> 1U) & 0x07U);
 
+            /* verify length of streamed OD entry */
+            if(SDO->stream != NULL){
+                if((SDO->streamOffset + len) > SDO->stream->size){
+                    CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                    return -1;
+                }
+            }
+
             /* verify length. Domain data type enables length larger than SDO buffer size */
-            if((SDO->bufferOffset + len) > SDO->ODF_arg.dataLength){
+            else if((SDO->bufferOffset + len) > SDO->ODF_arg.dataLength){
                 if(SDO->ODF_arg.ODdataStorage != 0){
                     CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
                     return -1;
@@ -984,14 +1527,25 @@ int8_t CO_SDO_process(
                 }
             }
 
-            /* copy data to buffer */
-            for(i=0U; i<len; i++)
-                SDO->ODF_arg.data[SDO->bufferOffset++] = SDO->CANrxData[i+1];
+            /* copy data to buffer, streamed data directly to its memory region */
+            if(SDO->stream != NULL){
+                for(i=0U; i<len; i++)
+                    SDO->stream->pData[SDO->streamOffset++] = SDO->CANrxData[i+1];
+            }
+            else{
+                for(i=0U; i<len; i++)
+                    SDO->ODF_arg.data[SDO->bufferOffset++] = SDO->CANrxData[i+1];
+            }
 
             /* If no more segments to be downloaded, write data to the Object dictionary */
             if((SDO->CANrxData[0] & 0x01U) != 0U){
-                SDO->ODF_arg.lastSegment = true;
-                abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+                if(SDO->stream != NULL){
+                    abortCode = CO_SDO_streamEnd(SDO, true);
+                }
+                else{
+                    SDO->ODF_arg.lastSegment = true;
+                    abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+                }
                 if(abortCode != 0U){
                     CO_SDO_abort(SDO, abortCode);
                     return -1;
@@ -1021,8 +1575,13 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[2] = SDO->CANrxData[2];
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
-            /* blksize */
-            SDO->blksize = (CO_SDO_BUFFER_SIZE > (7*127)) ? 127 : (CO_SDO_BUFFER_SIZE / 7);
+            /* blksize, streamed data are not limited by SDO buffer */
+            if(SDO->stream != NULL){
+                SDO->blksize = 127;
+            }
+            else{
+                SDO->blksize = (CO_SDO_BUFFER_SIZE > (7*127)) ? 127 : (CO_SDO_BUFFER_SIZE / 7);
+            }
             SDO->CANtxBuff->data[4] = SDO->blksize;
 
             /* is CRC enabled */
@@ -1035,8 +1594,14 @@ int8_t CO_SDO_process(
                 CO_memcpySwap4(&lenRx, &SDO->CANrxData[4]);
                 SDO->ODF_arg.dataLengthTotal = lenRx;
 
-                /* verify length except for domain data type */
-                if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
+                /* verify length except for domain data type and streamed entry */
+                if(SDO->stream != NULL){
+                    if(lenRx > SDO->stream->size){
+                        CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                        return -1;
+                    }
+                }
+                else if((lenRx != SDO->ODF_arg.dataLength) && (SDO->ODF_arg.ODdataStorage != 0)){
                     CO_SDO_abort(SDO, CO_SDO_AB_TYPE_MISMATCH);  /* Length of service parameter does not match */
                     return -1;
                 }
@@ -1066,8 +1631,21 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[1] = SDO->sequence;
             SDO->sequence = 0;
 
+            /* streamed data: verify length and advance offset if not last segment */
+            if((SDO->stream != NULL) && !lastSegmentInSubblock){
+                if((SDO->streamOffset + SDO->bufferOffset) > SDO->stream->size){
+                    CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                    return -1;
+                }
+                if(SDO->crcEnabled){
+                    SDO->crc = crc16_ccitt(&SDO->stream->pData[SDO->streamOffset], SDO->bufferOffset, SDO->crc);
+                }
+                SDO->streamOffset += SDO->bufferOffset;
+                SDO->bufferOffset = 0;
+            }
+
             /* empty buffer in domain data type if not last segment */
-            if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->bufferOffset != 0) && !lastSegmentInSubblock){
+            else if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->bufferOffset != 0) && !lastSegmentInSubblock){
                 /* calculate CRC on next bytes, if enabled */
                 if(SDO->crcEnabled){
                     SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->bufferOffset, SDO->crc);
@@ -1086,15 +1664,20 @@ int8_t CO_SDO_process(
             }
 
             /* blksize */
-            len = CO_SDO_BUFFER_SIZE - SDO->bufferOffset;
-            SDO->blksize = (len > (7*127)) ? 127 : (len / 7);
+            if(SDO->stream != NULL){
+                SDO->blksize = 127;
+            }
+            else{
+                len = CO_SDO_BUFFER_SIZE - SDO->bufferOffset;
+                SDO->blksize = (len > (7*127)) ? 127 : (len / 7);
+            }
             SDO->CANtxBuff->data[2] = SDO->blksize;
 
             /* set next state */
             if(lastSegmentInSubblock) {
                 SDO->state = CO_SDO_ST_DOWNLOAD_BL_END;
             }
-            else if(SDO->bufferOffset >= CO_SDO_BUFFER_SIZE) {
+            else if((SDO->stream == NULL) && (SDO->bufferOffset >= CO_SDO_BUFFER_SIZE)) {
                 CO_SDO_abort(SDO, CO_SDO_AB_DEVICE_INCOMPAT);
                 return -1;
             }
@@ -1119,10 +1702,21 @@ int8_t CO_SDO_process(
             len = (SDO->CANrxData[0]>>2U) & 0x07U;
             SDO->bufferOffset -= len;
 
+            /* verify length of streamed data */
+            if((SDO->stream != NULL) && ((SDO->streamOffset + SDO->bufferOffset) > SDO->stream->size)){
+                CO_SDO_abort(SDO, CO_SDO_AB_DATA_LONG);  /* Length of service parameter too high */
+                return -1;
+            }
+
             /* calculate and verify CRC, if enabled */
             if(SDO->crcEnabled){
                 uint16_t crc;
-                SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->bufferOffset, SDO->crc);
+                if(SDO->stream != NULL){
+                    SDO->crc = crc16_ccitt(&SDO->stream->pData[SDO->streamOffset], SDO->bufferOffset, SDO->crc);
+                }
+                else{
+                    SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->bufferOffset, SDO->crc);
+                }
 
                 CO_memcpySwap2(&crc, &SDO->CANrxData[1]);
 
@@ -1132,9 +1726,15 @@ int8_t CO_SDO_process(
                 }
             }
 
-            /* write data to the Object dictionary */
-            SDO->ODF_arg.lastSegment = true;
-            abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+            /* write data to the Object dictionary or commit streamed data */
+            if(SDO->stream != NULL){
+                SDO->streamOffset += SDO->bufferOffset;
+                abortCode = CO_SDO_streamEnd(SDO, true);
+            }
+            else{
+                SDO->ODF_arg.lastSegment = true;
+                abortCode = CO_SDO_writeOD(SDO, SDO->bufferOffset);
+            }
             if(abortCode != 0U){
                 CO_SDO_abort(SDO, abortCode);
                 return -1;
@@ -1148,17 +1748,23 @@ int8_t CO_SDO_process(
         }
 
         case CO_SDO_ST_UPLOAD_INITIATE:{
+            uint32_t dataLength = (SDO->stream != NULL) ? SDO->stream->dataLength : SDO->ODF_arg.dataLength;
+
             /* default response */
             SDO->CANtxBuff->data[1] = SDO->CANrxData[1];
             SDO->CANtxBuff->data[2] = SDO->CANrxData[2];
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
-            /* Expedited transfer */
-            if(SDO->ODF_arg.dataLength <= 4U){
-                for(i=0U; i<SDO->ODF_arg.dataLength; i++)
-                    SDO->CANtxBuff->data[4U+i] = SDO->ODF_arg.data[i];
+            /* Expedited transfer, short streamed data directly from its memory
+             * region. Expedited response can not indicate empty data. */
+            if((dataLength >= 1U) && (dataLength <= 4U)){
+                const uint8_t *src = (SDO->stream != NULL) ? SDO->stream->pData : SDO->ODF_arg.data;
 
-                SDO->CANtxBuff->data[0] = 0x43U | ((4U-SDO->ODF_arg.dataLength) << 2U);
+                len = (uint16_t)dataLength;
+                for(i=0U; i<len; i++)
+                    SDO->CANtxBuff->data[4U+i] = src[i];
+
+                SDO->CANtxBuff->data[0] = 0x43U | ((4U-len) << 2U);
                 SDO->state = CO_SDO_ST_IDLE;
 
                 sendResponse = true;
@@ -1170,8 +1776,8 @@ int8_t CO_SDO_process(
                 SDO->sequence = 0U;
                 SDO->state = CO_SDO_ST_UPLOAD_SEGMENTED;
 
-                /* indicate data size, if known */
-                if(SDO->ODF_arg.dataLengthTotal != 0U){
+                /* indicate data size, if known, also zero size of empty stream */
+                if((SDO->ODF_arg.dataLengthTotal != 0U) || (SDO->stream != NULL)){
                     uint32_t len = SDO->ODF_arg.dataLengthTotal;
                     CO_memcpySwap4(&SDO->CANtxBuff->data[4], &len);
                     SDO->CANtxBuff->data[0] = 0x41U;
@@ -1200,6 +1806,28 @@ int8_t CO_SDO_process(
                 return -1;
             }
 
+            /* streamed data are sent directly from its memory region */
+            if(SDO->stream != NULL){
+                uint32_t remaining = SDO->stream->dataLength - SDO->streamOffset;
+
+                len = (remaining > 7U) ? 7U : (uint16_t)remaining;
+                for(i=0U; i<len; i++)
+                    SDO->CANtxBuff->data[i+1] = SDO->stream->pData[SDO->streamOffset++];
+                for(; i<7U; i++)
+                    SDO->CANtxBuff->data[i+1] = 0U;
+
+                SDO->CANtxBuff->data[0] = 0x00 | (SDO->sequence ? 0x10 : 0x00) | ((7-len)<<1);
+                SDO->sequence = (SDO->sequence) ? 0 : 1;
+
+                if(SDO->streamOffset == SDO->stream->dataLength){
+                    SDO->CANtxBuff->data[0] |= 0x01;
+                    SDO->state = CO_SDO_ST_IDLE;
+                }
+
+                sendResponse = true;
+                break;
+            }
+
             /* calculate length to be sent */
             len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
             if(len > 7U) len = 7U;
@@ -1257,10 +1885,10 @@ int8_t CO_SDO_process(
             SDO->CANtxBuff->data[2] = SDO->CANrxData[2];
             SDO->CANtxBuff->data[3] = SDO->CANrxData[3];
 
-            /* calculate CRC, if enabled */
+            /* calculate CRC, if enabled. CRC of streamed data is calculated on acknowledged segments. */
             if((SDO->CANrxData[0] & 0x04U) != 0U){
                 SDO->crcEnabled = true;
-                SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, 0);
+                SDO->crc = (SDO->stream != NULL) ? 0 : crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, 0);
             }
             else{
                 SDO->crcEnabled = false;
@@ -1278,7 +1906,7 @@ int8_t CO_SDO_process(
 
             /* verify blksize and if SDO data buffer is large enough */
             if((SDO->blksize < 1U) || (SDO->blksize > 127U) ||
-               (((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment))){
+               ((SDO->stream == NULL) && ((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment))){
                 CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
                 return -1;
             }
@@ -1307,6 +1935,7 @@ int8_t CO_SDO_process(
             }
 
             SDO->bufferOffset = 0;
+            SDO->bufferStart = 0;
             SDO->sequence = 0;
             SDO->endOfTransfer = false;
             SDO->CANrxNew = false;
@@ -1318,7 +1947,6 @@ int8_t CO_SDO_process(
             /* is block confirmation received */
             if(SDO->CANrxNew){
                 uint8_t ackseq;
-                uint16_t j;
 
                 /* verify client command specifier and subcommand */
                 if((SDO->CANrxData[0]&0xE3U) != 0xA2U){
@@ -1334,6 +1962,20 @@ int8_t CO_SDO_process(
                     return -1;
                 }
 
+                /* streamed data: calculate CRC on acknowledged bytes and advance */
+                if(SDO->stream != NULL){
+                    uint32_t acked = (uint32_t)ackseq * 7U;
+                    uint32_t remaining = SDO->stream->dataLength - SDO->streamOffset;
+
+                    if(acked > remaining){
+                        acked = remaining;
+                    }
+                    if(SDO->crcEnabled){
+                        SDO->crc = crc16_ccitt(&SDO->stream->pData[SDO->streamOffset], (unsigned int)acked, SDO->crc);
+                    }
+                    SDO->streamOffset += acked;
+                }
+
                 /* end of transfer */
                 if((SDO->endOfTransfer) && (ackseq == SDO->blksize)){
                     /* first response byte */
@@ -1350,42 +1992,36 @@ int8_t CO_SDO_process(
                     break;
                 }
 
-                /* move remaining data to the beginning */
-                for(i=ackseq*7, j=0; i<SDO->ODF_arg.dataLength; i++, j++)
-                    SDO->ODF_arg.data[j] = SDO->ODF_arg.data[i];
-
-                /* set remaining data length in buffer */
-                SDO->ODF_arg.dataLength -= ackseq * 7U;
-
                 /* new block size */
                 SDO->blksize = SDO->CANrxData[2];
 
-                /* If data type is domain, re-fill the data buffer if necessary and indicated so. */
-                if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->ODF_arg.dataLength < (SDO->blksize*7U)) && (!SDO->ODF_arg.lastSegment)){
-                    /* move the beginning of the data buffer */
-                    len = SDO->ODF_arg.dataLength; /* length of valid data in buffer */
-                    SDO->ODF_arg.data += len;
-                    SDO->ODF_arg.dataLength = CO_OD_getLength(SDO, SDO->entryNo, SDO->ODF_arg.subIndex) - len;
-
-                    /* read next data from Object dictionary function */
-                    abortCode = CO_SDO_readOD(SDO, CO_SDO_BUFFER_SIZE);
-                    if(abortCode != 0U){
-                        CO_SDO_abort(SDO, abortCode);
-                        return -1;
+                if(SDO->stream == NULL){
+                    /* release acknowledged segments from the ring buffer, remaining data stays in place */
+                    len = ackseq * 7U;
+                    SDO->bufferStart += len;
+                    if(SDO->bufferStart >= CO_SDO_BUFFER_SIZE){
+                        SDO->bufferStart -= CO_SDO_BUFFER_SIZE;
                     }
 
-                    /* calculate CRC on next bytes, if enabled */
-                    if(SDO->crcEnabled){
-                        SDO->crc = crc16_ccitt(SDO->ODF_arg.data, SDO->ODF_arg.dataLength, SDO->crc);
+                    /* set remaining data length in buffer */
+                    SDO->ODF_arg.dataLength -= len;
+
+                    /* If data type is domain, re-fill the data buffer if necessary and indicated so. */
+                    if((SDO->ODF_arg.ODdataStorage == 0) && (SDO->ODF_arg.dataLength < (SDO->blksize*7U)) && (!SDO->ODF_arg.lastSegment)){
+                        abortCode = CO_SDO_uploadFillRing(SDO);
+                        if(abortCode != 0U){
+                            CO_SDO_abort(SDO, abortCode);
+                            return -1;
+                        }
                     }
 
-                  /* return to the original data buffer */
-                    SDO->ODF_arg.data -= len;
-                    SDO->ODF_arg.dataLength +=  len;
+                    /* verify if SDO data buffer is large enough */
+                    if(((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment)){
+                        CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
+                        return -1;
+                    }
                 }
-
-                /* verify if SDO data buffer is large enough */
-                if(((SDO->blksize*7U) > SDO->ODF_arg.dataLength) && (!SDO->ODF_arg.lastSegment)){
+                else if((SDO->blksize < 1U) || (SDO->blksize > 127U)){
                     CO_SDO_abort(SDO, CO_SDO_AB_BLOCK_SIZE); /* Invalid block size (block mode only). */
                     return -1;
                 }
@@ -1398,41 +2034,67 @@ int8_t CO_SDO_process(
                 SDO->CANrxNew = false;
             }
 
-            /* return, if all segments was already transfered or on end of transfer */
-            if((SDO->sequence == SDO->blksize) || (SDO->endOfTransfer)){
-                return 1;/* don't clear the SDO->CANrxNew flag, so return directly */
-            }
+            /* send as many segments, as there are free CAN transmit buffers */
+            while((SDO->sequence < SDO->blksize) && (!SDO->endOfTransfer) && (!SDO->CANtxBuff->bufferFull)){
+                uint16_t rd;
 
-            /* reset timeout */
-            SDO->timeoutTimer = 0;
+                /* reset timeout */
+                SDO->timeoutTimer = 0;
 
-            /* calculate length to be sent */
-            len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
-            if(len > 7U){
-                len = 7U;
-            }
+                if(SDO->stream != NULL){
+                    /* streamed data are sent directly from its memory region */
+                    const uint8_t *src = &SDO->stream->pData[SDO->streamOffset + SDO->bufferOffset];
+                    uint32_t remaining = SDO->stream->dataLength - SDO->streamOffset - SDO->bufferOffset;
 
-            /* fill response data bytes */
-            for(i=0U; i<len; i++){
-                SDO->CANtxBuff->data[i+1] = SDO->ODF_arg.data[SDO->bufferOffset++];
-            }
+                    len = (remaining > 7U) ? 7U : (uint16_t)remaining;
+                    for(i=0U; i<len; i++){
+                        SDO->CANtxBuff->data[i+1] = src[i];
+                    }
+                }
+                else{
+                    /* calculate length to be sent */
+                    len = SDO->ODF_arg.dataLength - SDO->bufferOffset;
+                    if(len > 7U){
+                        len = 7U;
+                    }
 
-            /* first response byte */
-            SDO->CANtxBuff->data[0] = ++SDO->sequence;
+                    /* fill response data bytes from the ring buffer */
+                    rd = SDO->bufferStart + SDO->bufferOffset;
+                    if(rd >= CO_SDO_BUFFER_SIZE){
+                        rd -= CO_SDO_BUFFER_SIZE;
+                    }
+                    for(i=0U; i<len; i++){
+                        SDO->CANtxBuff->data[i+1] = SDO->databuffer[rd];
+                        if(++rd == CO_SDO_BUFFER_SIZE){
+                            rd = 0U;
+                        }
+                    }
+                }
+                for(i=len; i<7U; i++){
+                    SDO->CANtxBuff->data[i+1] = 0U;
+                }
+                SDO->bufferOffset += len;
+
+                /* first response byte */
+                SDO->CANtxBuff->data[0] = ++SDO->sequence;
+
+                /* verify end of transfer */
+                if((SDO->stream != NULL)
+                    ? ((SDO->streamOffset + SDO->bufferOffset) == SDO->stream->dataLength)
+                    : ((SDO->bufferOffset == SDO->ODF_arg.dataLength) && (SDO->ODF_arg.lastSegment))){
+                    SDO->CANtxBuff->data[0] |= 0x80;
+                    SDO->lastLen = len;
+                    SDO->blksize = SDO->sequence;
+                    SDO->endOfTransfer = true;
+                }
 
-            /* verify end of transfer */
-            if((SDO->bufferOffset == SDO->ODF_arg.dataLength) && (SDO->ODF_arg.lastSegment)){
-                SDO->CANtxBuff->data[0] |= 0x80;
-                SDO->lastLen = len;
-                SDO->blksize = SDO->sequence;
-                SDO->endOfTransfer = true;
+                /* send response */
+                CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
             }
 
-            /* send response */
-            CO_CANsend(SDO->CANdevTx, SDO->CANtxBuff);
-
-            /* Set timerNext_ms to 0 to inform OS to call this function again without delay. */
-            if(timerNext_ms != NULL){
+            /* Set timerNext_ms to 0 to inform OS to call this function again without delay,
+             * if segments are left because CAN transmit buffer was full. */
+            if((SDO->sequence < SDO->blksize) && (!SDO->endOfTransfer) && (timerNext_ms != NULL)){
                 *timerNext_ms = 0;
             }
 
@@ -1467,5 +2129,6 @@ int8_t CO_SDO_process(
         return 1;
     }
 
+    SDO->stream = NULL;
     return 0;
 }
@@ -295,6 +295,15 @@ typedef enum{
  * Be aware that accessing the OD directly using CO_OD.h files is more CPU 
  * efficient as CO_OD_find() has to do a search everytime it is called.
  * 
+ * Change of state of TPDOs is detected only for OD entries, which are marked
+ * as changed. SDO server and RPDOs mark entries automatically. Application,
+ * which writes variable mapped to TPDO with change of state detection, must
+ * call CO_OD_markDirty() after the write, like this:
+ *
+ * \code{.c}
+ * OD_readInput8Bit[0] = inputs;
+ * CO_OD_markDirty(CO->SDO[0], entryNo_6000);
+ * \endcode
  */
 
 
@@ -352,6 +361,11 @@ typedef enum{
  * If data type is domain, data length is not limited to SDO buffer size. If
  * block transfer is implemented, value should be set to 889.
  *
+ * Block upload of objects, which are not streamed (see CO_OD_configureStream()),
+ * is sent from this buffer, so client may request at most
+ * CO_SDO_BUFFER_SIZE / 7 segments per sub-block, other block size is aborted.
+ * With the default size only streamed objects benefit from full sub-blocks.
+ *
  * Value can be in range from 7 to 889 bytes.
  */
     #ifndef CO_SDO_BUFFER_SIZE
@@ -359,6 +373,25 @@ typedef enum{
     #endif
 
 
+/**
+ * Size of the Object dictionary page table.
+ *
+ * Page table is array of uint16_t, filled by CO_SDO_init(). Element n contains
+ * number of the first OD entry with index high byte equal or greater than n,
+ * last element contains ODSize. CO_OD_find() uses it to jump directly to the
+ * entries with the same index high byte.
+ */
+#define CO_OD_PAGE_TABLE_SIZE   257
+
+
+/**
+ * Number of uint32_t words in the bitmap of changed OD entries.
+ *
+ * Bitmap has one bit for each OD entry, see CO_OD_markDirty().
+ */
+#define CO_OD_DIRTY_SIZE(ODSize)   (((ODSize) + 31U) / 32U)
+
+
 /**
  * Object Dictionary attributes. Bit masks for attribute in CO_OD_entry_t.
  */
@@ -373,7 +406,9 @@ typedef enum{
     CO_ODA_TPDO_DETECT_COS  = 0x0040U,  /**< If variable is mapped to any PDO, then
                                              PDO is automatically send, if variable
                                              changes its value */
-    CO_ODA_MB_VALUE         = 0x0080U   /**< True when variable is a multibyte value */
+    CO_ODA_MB_VALUE         = 0x0080U,  /**< True when variable is a multibyte value */
+    CO_ODA_SIGNED           = 0x0100U   /**< Variable is signed integer, value received
+                                             in shorter PDO mapping is sign extended */
 }CO_SDO_OD_attributes_t;
 
 
@@ -586,13 +621,82 @@ typedef struct{
 }CO_ODF_arg_t;
 
 
+/**
+ * Streaming object for large Object dictionary entries.
+ *
+ * One sub-index of an OD entry exposes a contiguous memory region, which is
+ * read or written directly by SDO segmented and block transfers. Data does not
+ * pass through SDO databuffer, @ref CO_SDO_OD_function is not called and
+ * #CO_SDO_BUFFER_SIZE does not limit the size. CRC of the block transfer is
+ * calculated on the fly. At the end of download pFunctCommit is called with
+ * commit = true. If download is aborted, it is called with commit = false, so
+ * application can roll back partially written data.
+ *
+ * Stream is configured by CO_OD_configureStream().
+ */
+typedef struct{
+    /** Start of the memory region */
+    uint8_t            *pData;
+    /** Size of the memory region in bytes */
+    uint32_t            size;
+    /** Number of valid bytes in the memory region. Used as data size in
+    upload, set by the SDO server after successful download. */
+    uint32_t            dataLength;
+    /** Sub-index of the OD entry, which is streamed */
+    uint8_t             subIndex;
+    /** Pointer to object, which will be passed to pFunctCommit */
+    void               *object;
+    /** Called at the end of download with number of received bytes. Return
+    value is ignored on rollback. On commit, abort code other than
+    CO_SDO_AB_NONE rejects the data. May be NULL. */
+    CO_SDO_abortCode_t (*pFunctCommit)(void *object, bool_t commit, uint32_t dataLength);
+}CO_SDO_stream_t;
+
+
+/**
+ * Precomputed description of one sub-index of @ref CO_SDO_objectDictionary entry.
+ *
+ * Array of descriptors is built by CO_SDO_init(). One lookup returns everything
+ * needed for SDO or PDO access, without decoding type of the object.
+ */
+typedef struct{
+    /** Pointer to data, see CO_OD_getDataPointer() */
+    void               *pData;
+    /** Data length, see CO_OD_getLength() */
+    uint16_t            length;
+    /** Attribute, see CO_OD_getAttribute() */
+    uint16_t            attribute;
+}CO_OD_descriptor_t;
+
+
 /**
  * Object is used as array inside CO_SDO_t, parallel to @ref CO_SDO_objectDictionary.
  *
- * Object is generated by function CO_OD_configure(). It is then used as
- * extension to Object dictionary entry at specific index.
+ * Holds the state, which every OD entry needs for SDO and PDO access.
  */
 typedef struct{
+    /** Offset of the first descriptor of the entry in the array of
+    #CO_OD_descriptor_t, built by CO_SDO_init(). Entry has maxSubIndex+1
+    descriptors. */
+    uint16_t            descriptor;
+    /** Sequence counter of OD entry data. Odd while data is being written, see
+    CO_OD_writeBegin(). */
+    volatile uint16_t   seq;
+}CO_OD_entryInfo_t;
+
+
+/**
+ * Extension to Object dictionary entry at specific index.
+ *
+ * Object is generated by function CO_OD_configure() or
+ * CO_OD_configureStream(). Only few OD entries are extended, so extensions are
+ * stored in hash table inside CO_SDO_t with key entryNo and open addressing.
+ * Extension never moves once it is created, so pointer to it stays valid.
+ */
+typedef struct{
+    /** Sequence number of OD entry as returned from CO_OD_find() or 0xFFFF,
+    if this element of the hash table is free */
+    uint16_t            entryNo;
     /** Pointer to @ref CO_SDO_OD_function */
     CO_SDO_abortCode_t (*pODFunc)(CO_ODF_arg_t *ODF_arg);
     /** Pointer to object, which will be passed to @ref CO_SDO_OD_function */
@@ -600,6 +704,8 @@ typedef struct{
     /** Pointer to #CO_SDO_OD_flags_t. If object type is array or record, this
     variable points to array with length equal to number of subindexes. */
     uint8_t            *flags;
+    /** From CO_OD_configureStream() or NULL */
+    CO_SDO_stream_t    *stream;
 }CO_OD_extension_t;
 
 
@@ -617,16 +723,51 @@ typedef struct{
     const CO_OD_entry_t *OD;
     /** Size of the @ref CO_SDO_objectDictionary */
     uint16_t            ODSize;
-    /** Pointer to array of CO_OD_extension_t objects. Size of the array is
-    equal to ODSize. */
+    /** Pointer to hash table of CO_OD_extension_t objects or NULL */
     CO_OD_extension_t  *ODExtensions;
-    /** Offset in buffer of next data segment being read/written */
+    /** Size of the above hash table */
+    uint16_t            ODExtensionsSize;
+    /** Number of used elements in the above hash table. It changes, when new
+    extension is added, so cached extension pointers can be searched again. */
+    uint16_t            ODExtensionsUsed;
+    /** Pointer to array of CO_OD_entryInfo_t objects or NULL. Size of the
+    array is equal to ODSize. */
+    CO_OD_entryInfo_t  *ODInfo;
+    /** Pointer to array of descriptors of all sub-indexes or NULL, if
+    descriptors are not used */
+    const CO_OD_descriptor_t *ODDescriptors;
+    /** Pointer to page table of size #CO_OD_PAGE_TABLE_SIZE or NULL, if page
+    table is not used. */
+    const uint16_t     *ODPages;
+    /** Bitmap of changed OD entries of size CO_OD_DIRTY_SIZE(ODSize) or NULL.
+    Bit is set by CO_OD_markDirty() and cleared by CO_OD_getChangedTPDOs(). */
+    uint32_t           *ODDirty;
+    /** Reverse index of size ODSize or NULL: bit n in element entryNo is set,
+    if TPDO n maps the OD entry with change of state detection. */
+    uint32_t           *ODTPDOMap;
+    /** Set by CO_SDO_writeOD(), if written OD entry is processed by the real
+    time context: SYNC parameter (0x1005 - 0x1007), TPDO parameter (0x1800 -
+    0x1BFF) or entry mapped to TPDO. Cleared by CO_process(). */
+    bool_t              PDOchanged;
+    /** Offset in buffer of next data segment being read/written. In block
+    upload it is relative to bufferStart. */
     uint16_t            bufferOffset;
+    /** Block upload only: databuffer is used as ring buffer and this is the
+    position of the first not yet acknowledged byte. Segment with sequence
+    number n is at bufferStart + (n-1)*7, so data is never moved. */
+    uint16_t            bufferStart;
     /** Sequence number of OD entry as returned from CO_OD_find() */
     uint16_t            entryNo;
+    /** Extension of the OD entry of the current transfer or NULL */
+    CO_OD_extension_t  *extension;
     /** CO_ODF_arg_t object with additional variables. Reference to this object
     is passed to @ref CO_SDO_OD_function */
     CO_ODF_arg_t        ODF_arg;
+    /** Stream of the current transfer, if OD entry is streamed, otherwise NULL */
+    CO_SDO_stream_t    *stream;
+    /** Position in stream memory region of the next segment (segmented
+    transfer) or of the first byte of the current sub-block (block transfer) */
+    uint32_t            streamOffset;
     /** From CO_SDO_init() */
     uint8_t             nodeId;
     /** Current internal state of the SDO server state machine #CO_SDO_state_t */
@@ -755,12 +896,36 @@ void CO_memcpySwap8(void* dest, const void* src);
  * @param ObjDictIndex_SDOServerParameter Index in Object dictionary.
  * @param parentSDO Pointer to SDO object, which contains object dictionary and
  * its extension. For first (default) SDO object this argument must be NULL.
- * If this argument is specified, then OD, ODSize and ODExtensions arguments
- * are ignored.
+ * If this argument is specified, then OD, ODSize, ODExtensions, ODInfo and
+ * following arguments up to ODTPDOMap are ignored.
  * @param OD Pointer to @ref CO_SDO_objectDictionary array defined externally.
+ * If NULL and SDO object was initialized before with own OD, then OD, its
+ * tables and extensions are kept (fast communication reset) and following
+ * arguments up to ODTPDOMap are ignored.
  * @param ODSize Size of the above array.
- * @param ODExtensions Pointer to the externally defined array of the same size
- * as ODSize.
+ * @param ODExtensions Pointer to the externally defined hash table of
+ * extensions. It should have about one and a half times more elements than
+ * there are calls to CO_OD_configure() and CO_OD_configureStream() for
+ * different OD entries. May be NULL.
+ * @param ODExtensionsSize Size of the above array.
+ * @param ODInfo Pointer to the externally defined array of the same size as
+ * ODSize. May be NULL, then data of OD entries is not protected with sequence
+ * counters and descriptors are not used.
+ * @param ODPages Pointer to the externally defined array of size
+ * #CO_OD_PAGE_TABLE_SIZE. It is filled here and used by CO_OD_find(). May be
+ * NULL, then it may be built later by CO_OD_buildTables(). If OD is not
+ * ordered by index, page table is not used.
+ * @param ODDescriptors Pointer to the externally defined array of
+ * #CO_OD_descriptor_t. It is filled here with descriptors of all sub-indexes.
+ * May be NULL, then it may be built later by CO_OD_buildTables().
+ * @param ODDescriptorsSize Size of the above array. If it is smaller than
+ * total number of sub-indexes in OD, descriptors are not used.
+ * @param ODDirty Pointer to the externally defined array of size
+ * CO_OD_DIRTY_SIZE(ODSize). May be NULL, then change of state of all TPDOs is
+ * verified on each cycle.
+ * @param ODTPDOMap Pointer to the externally defined array of the same size
+ * as ODSize. It is filled by CO_TPDO_init(). Must not be NULL, if ODDirty is
+ * used.
  * @param nodeId CANopen Node ID of this device.
  * @param CANdevRx CAN device for SDO server reception.
  * @param CANdevRxIdx Index of receive buffer in the above CAN device.
@@ -778,6 +943,13 @@ CO_ReturnError_t CO_SDO_init(
         const CO_OD_entry_t     OD[],
         uint16_t                ODSize,
         CO_OD_extension_t       ODExtensions[],
+        uint16_t                ODExtensionsSize,
+        CO_OD_entryInfo_t       ODInfo[],
+        uint16_t                ODPages[],
+        CO_OD_descriptor_t      ODDescriptors[],
+        uint16_t                ODDescriptorsSize,
+        uint32_t                ODDirty[],
+        uint32_t                ODTPDOMap[],
         uint8_t                 nodeId,
         CO_CANmodule_t         *CANdevRx,
         uint16_t                CANdevRxIdx,
@@ -785,6 +957,28 @@ CO_ReturnError_t CO_SDO_init(
         uint16_t                CANdevTxIdx);
 
 
+/**
+ * Build page table and descriptors of Object Dictionary, which were not
+ * built by CO_SDO_init().
+ *
+ * Function may be called from mainline after boot-up message is sent, so
+ * building of tables does not delay it. Until then CO_OD_find() uses binary
+ * search and descriptors are decoded from OD on each access. Each table is
+ * used only after it is completely filled, so real time context may run
+ * meanwhile. Tables, which are already built, are not changed.
+ *
+ * @param SDO SDO object with own Object Dictionary.
+ * @param ODPages See CO_SDO_init().
+ * @param ODDescriptors See CO_SDO_init().
+ * @param ODDescriptorsSize See CO_SDO_init().
+ */
+void CO_OD_buildTables(
+        CO_SDO_t               *SDO,
+        uint16_t                ODPages[],
+        CO_OD_descriptor_t      ODDescriptors[],
+        uint16_t                ODDescriptorsSize);
+
+
 /**
  * Initialize SDOrx callback function.
  *
@@ -830,6 +1024,8 @@ int8_t CO_SDO_process(
  * Additional functionality include: @ref CO_SDO_OD_function and
  * #CO_SDO_OD_flags_t. It is optional feature and can be used on any object in
  * Object dictionary. If OD entry does not exist, function returns silently.
+ * Function is called in the communication reset section only, it may add new
+ * element into the hash table of extensions.
  *
  * @param SDO This object.
  * @param index Index of object in the Object dictionary.
@@ -841,8 +1037,11 @@ int8_t CO_SDO_process(
  * @param flagsSize Size of the above array. It must be equal to number
  * of sub-objects in object dictionary entry. Otherwise #CO_SDO_OD_flags_t will
  * not be used on this OD entry.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_OUT_OF_MEMORY, if hash
+ * table of extensions is full.
  */
-void CO_OD_configure(
+CO_ReturnError_t CO_OD_configure(
         CO_SDO_t               *SDO,
         uint16_t                index,
         CO_SDO_abortCode_t    (*pODFunc)(CO_ODF_arg_t *ODF_arg),
@@ -851,9 +1050,34 @@ void CO_OD_configure(
         uint8_t                 flagsSize);
 
 
+/**
+ * Configure streaming of one sub-index of @ref CO_SDO_objectDictionary entry.
+ *
+ * SDO transfers of this sub-index then read from and write to the memory
+ * region of the stream directly, see #CO_SDO_stream_t. If OD entry does not
+ * exist, function returns silently.
+ *
+ * @param SDO This object.
+ * @param index Index of object in the Object dictionary.
+ * @param stream Pointer to externally defined stream object. If NULL,
+ * streaming is disabled on this OD entry.
+ *
+ * @return #CO_ReturnError_t: CO_ERROR_NO or CO_ERROR_OUT_OF_MEMORY, if hash
+ * table of extensions is full.
+ */
+CO_ReturnError_t CO_OD_configureStream(
+        CO_SDO_t               *SDO,
+        uint16_t                index,
+        CO_SDO_stream_t        *stream);
+
+
 /**
  * Find object with specific index in Object dictionary.
  *
+ * If page table is available, search is limited to the entries with the same
+ * index high byte and the entry is usually found at the first attempt.
+ * Otherwise binary search over the whole ordered Object dictionary is used.
+ *
  * @param SDO This object.
  * @param index Index of the object in Object dictionary.
  *
@@ -913,11 +1137,136 @@ void* CO_OD_getDataPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex);
  * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
  * @param subIndex Sub-index of the object in Object dictionary.
  *
- * @return Pointer to the #CO_SDO_OD_flags_t of the variable.
+ * @return Pointer to the #CO_SDO_OD_flags_t of the variable or NULL, if flags
+ * are not configured for the OD entry.
  */
 uint8_t* CO_OD_getFlagsPointer(CO_SDO_t *SDO, uint16_t entryNo, uint8_t subIndex);
 
 
+/**
+ * Get extension of the given object.
+ *
+ * Extension is searched in the hash table, usually at the first attempt.
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ *
+ * @return Pointer to the extension or NULL, if OD entry was not configured
+ * by CO_OD_configure() or CO_OD_configureStream().
+ */
+CO_OD_extension_t* CO_OD_getExtension(CO_SDO_t *SDO, uint16_t entryNo);
+
+
+/**
+ * Get data pointer, length and attribute of the given object with specific
+ * subIndex at once.
+ *
+ * Values are the same as from CO_OD_getDataPointer(), CO_OD_getLength() and
+ * CO_OD_getAttribute(). If descriptors were built by CO_SDO_init(), they are
+ * copied from the table, otherwise they are decoded from the OD entry.
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ * @param subIndex Sub-index of the object in Object dictionary.
+ * @param desc Pointer to externally defined descriptor, which will be filled.
+ */
+void CO_OD_getDescriptor(
+        CO_SDO_t               *SDO,
+        uint16_t                entryNo,
+        uint8_t                 subIndex,
+        CO_OD_descriptor_t     *desc);
+
+
+/**
+ * Mark OD entry as changed.
+ *
+ * TPDOs, which map the entry with change of state detection, will verify
+ * their data on the next CO_process_TPDO(). Function is called by SDO server
+ * and by RPDOs. Application must call it after it writes OD variable, which is
+ * mapped to TPDO with change of state detection.
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ */
+void CO_OD_markDirty(CO_SDO_t *SDO, uint16_t entryNo);
+
+
+/**
+ * Start writing data of OD entry.
+ *
+ * Increments sequence counter of the entry to odd value. Readers, which run
+ * meanwhile, see it and retry. Writing must be finished with CO_OD_writeEnd().
+ * Interrupts are disabled only while the counter is incremented, not while
+ * data is copied.
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ */
+void CO_OD_writeBegin(CO_SDO_t *SDO, uint16_t entryNo);
+
+
+/**
+ * Finish writing data of OD entry.
+ *
+ * Increments sequence counter of the entry to even value and marks entry as
+ * changed, see CO_OD_markDirty().
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ */
+void CO_OD_writeEnd(CO_SDO_t *SDO, uint16_t entryNo);
+
+
+/**
+ * Start reading consistent data of OD entry.
+ *
+ * Reader copies data and then calls CO_OD_readRetry() with the returned
+ * value. Reader, which can be interrupted by writer (for example SDO server or
+ * application in mainline), repeats until CO_OD_readRetry() returns false.
+ * Reader, which interrupts writer (for example TPDO in timer thread), can not
+ * wait for the writer and must try again later, like CO_TPDOsend().
+ *
+ * \code{.c}
+ * do{
+ *     seq = CO_OD_readBegin(SDO, entryNo);
+ *     value = OD_variable;
+ * }while(CO_OD_readRetry(SDO, entryNo, seq));
+ * \endcode
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ *
+ * @return Sequence counter of the entry.
+ */
+uint16_t CO_OD_readBegin(CO_SDO_t *SDO, uint16_t entryNo);
+
+
+/**
+ * Verify data read after CO_OD_readBegin().
+ *
+ * @param SDO This object.
+ * @param entryNo Sequence number of OD entry as returned from CO_OD_find().
+ * @param seq Value returned from CO_OD_readBegin().
+ *
+ * @return True, if data was written meanwhile and is not consistent.
+ */
+bool_t CO_OD_readRetry(CO_SDO_t *SDO, uint16_t entryNo, uint16_t seq);
+
+
+/**
+ * Get TPDOs, which map changed OD entries.
+ *
+ * Function clears all bits of changed OD entries. It is called from
+ * CO_process_TPDO().
+ *
+ * @param SDO This object.
+ *
+ * @return Bit n is set, if TPDO n maps OD entry, which changed since previous
+ * call. If change tracking is not used, all bits are set.
+ */
+uint32_t CO_OD_getChangedTPDOs(CO_SDO_t *SDO);
+
+
 /**
  * Initialize SDO transfer.
  *
@@ -84,6 +84,11 @@ static void CO_SYNC_receive(void *object, const CO_CANrxMsg_t *msg){
         }
         if(SYNC->CANrxNew) {
             SYNC->CANrxToggle = SYNC->CANrxToggle ? false : true;
+
+            /* Optional signal to RTOS, which can resume task, which handles SYNC. */
+            if(SYNC->pFunctSignal != NULL) {
+                SYNC->pFunctSignal();
+            }
         }
     }
 }
@@ -280,6 +285,7 @@ CO_ReturnError_t CO_SYNC_init(
 
     SYNC->em = em;
     SYNC->operatingState = operatingState;
+    SYNC->pFunctSignal = NULL;
 
     SYNC->CANdevRx = CANdevRx;
     SYNC->CANdevRxIdx = CANdevRxIdx;
@@ -314,11 +320,23 @@ CO_ReturnError_t CO_SYNC_init(
 }
 
 
+/******************************************************************************/
+void CO_SYNC_initCallback(
+        CO_SYNC_t              *SYNC,
+        void                  (*pFunctSignal)(void))
+{
+    if(SYNC != NULL){
+        SYNC->pFunctSignal = pFunctSignal;
+    }
+}
+
+
 /******************************************************************************/
 uint8_t CO_SYNC_process(
         CO_SYNC_t              *SYNC,
         uint32_t                timeDifference_us,
-        uint32_t                ObjDict_synchronousWindowLength)
+        uint32_t                ObjDict_synchronousWindowLength,
+        uint32_t               *timerNext_us)
 {
     uint8_t ret = 0;
     uint32_t timerNew;
@@ -366,6 +384,29 @@ uint8_t CO_SYNC_process(
         /* Verify timeout of SYNC */
         if(SYNC->periodTime && SYNC->timer > SYNC->periodTimeoutTime && *SYNC->operatingState == CO_NMT_OPERATIONAL)
             CO_errorReport(SYNC->em, CO_EM_SYNC_TIME_OUT, CO_EMC_COMMUNICATION, SYNC->timer);
+
+        /* Calculate, when next SYNC event is due and lower timerNext_us if necessary. */
+        if(timerNext_us != NULL){
+            uint32_t diff;
+
+            /* next SYNC message from producer */
+            if(SYNC->isProducer && SYNC->periodTime){
+                diff = (SYNC->timer < SYNC->periodTime) ? (SYNC->periodTime - SYNC->timer) : 0;
+                if(*timerNext_us > diff) *timerNext_us = diff;
+            }
+
+            /* end of synchronous window */
+            if(ObjDict_synchronousWindowLength && SYNC->curentSyncTimeIsInsideWindow){
+                diff = ObjDict_synchronousWindowLength - SYNC->timer + 1;
+                if(*timerNext_us > diff) *timerNext_us = diff;
+            }
+
+            /* SYNC timeout */
+            if(SYNC->periodTime && SYNC->timer <= SYNC->periodTimeoutTime && *SYNC->operatingState == CO_NMT_OPERATIONAL){
+                diff = SYNC->periodTimeoutTime - SYNC->timer + 1;
+                if(*timerNext_us > diff) *timerNext_us = diff;
+            }
+        }
     }
     else {
         SYNC->CANrxNew = false;
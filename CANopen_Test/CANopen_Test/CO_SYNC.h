@@ -121,6 +121,8 @@ typedef struct{
     CO_CANmodule_t     *CANdevTx;       /**< From CO_SYNC_init() */
     CO_CANtx_t         *CANtxBuff;      /**< CAN transmit buffer inside CANdevTx */
     uint16_t            CANdevTxIdx;    /**< From CO_SYNC_init() */
+    /** From CO_SYNC_initCallback() or NULL */
+    void              (*pFunctSignal)(void);
 }CO_SYNC_t;
 
 
@@ -157,6 +159,21 @@ CO_ReturnError_t CO_SYNC_init(
         uint16_t                CANdevTxIdx);
 
 
+/**
+ * Initialize SYNC callback function.
+ *
+ * Function initializes optional callback function, which is called after
+ * SYNC message is received from the CAN bus. Function may trigger processing
+ * of synchronous PDOs, if the real time context does not run periodically.
+ *
+ * @param SYNC This object.
+ * @param pFunctSignal Pointer to the callback function. Not called if NULL.
+ */
+void CO_SYNC_initCallback(
+        CO_SYNC_t              *SYNC,
+        void                  (*pFunctSignal)(void));
+
+
 /**
  * Process SYNC communication.
  *
@@ -166,6 +183,9 @@ CO_ReturnError_t CO_SYNC_init(
  * @param timeDifference_us Time difference from previous function call in [microseconds].
  * @param ObjDict_synchronousWindowLength _Synchronous window length_ variable from
  * Object dictionary (index 0x1007).
+ * @param timerNext_us Return value - info to OS - time in [microseconds] until
+ * next SYNC event (producer period, end of window or timeout). Lowered only,
+ * ignored if NULL.
  *
  * @return 0: No special meaning.
  * @return 1: New SYNC message recently received or was just transmitted.
@@ -174,7 +194,8 @@ CO_ReturnError_t CO_SYNC_init(
 uint8_t CO_SYNC_process(
         CO_SYNC_t              *SYNC,
         uint32_t                timeDifference_us,
-        uint32_t                ObjDict_synchronousWindowLength);
+        uint32_t                ObjDict_synchronousWindowLength,
+        uint32_t               *timerNext_us);
 
 #ifdef __cplusplus
 }
@@ -279,10 +279,47 @@ CO_ReturnError_t CO_CANmodule_init(
 		return CO_ERROR_HAL;
 	}
 
+	if(!CANmodule->useCANrxFilters)
+	{
+		/* no hardware filters, accept all standard identifiers. Set once
+		 * here, it is kept by communication reset. */
+		struct can_filter  filter;
+		filter.id   = 0x0;
+		filter.mask = 0;
+		can_async_set_filter(CANmodule->CANBaseDescriptor, 0, CAN_FMT_STDID, &filter);
+	}
+
 	return CO_ERROR_NO;
 }
 
 
+/******************************************************************************/
+void CO_CANmodule_reset(CO_CANmodule_t *CANmodule){
+	uint16_t i;
+
+	/* stop processing in the real time context */
+	CANmodule->CANnormal = false;
+
+	CO_LOCK_CAN_SEND();
+	/* identifier with bit 0 set never matches received message */
+	for(i=0U; i<CANmodule->rxSize; i++)
+	{
+		CANmodule->rxArray[i].pFunct = NULL;
+		CANmodule->rxArray[i].ident = 0xFFFFU;
+		CANmodule->rxArray[i].mask = 0xFFFFU;
+	}
+
+	for(i=0U; i<CANmodule->txSize; i++)
+	{
+		CANmodule->txArray[i].bufferFull = false;
+	}
+	CANmodule->CANtxCount = 0U;
+	CANmodule->bufferInhibitFlag = false;
+	CANmodule->firstCANtxMessage = true;
+	CO_UNLOCK_CAN_SEND();
+}
+
+
 /******************************************************************************/
 void CO_CANmodule_disable(CO_CANmodule_t *CANmodule){
 	/* turn off the module */
@@ -333,20 +370,12 @@ CO_ReturnError_t CO_CANrxBufferInit(
 		buffer->mask = (mask & 0x07FF) << 2;
 		buffer->mask |= 0x02;
 
-		/* Set CAN hardware module filter and mask. */
+		/* Set CAN hardware module filter and mask. Without hardware
+		 * filters all identifiers are accepted, see CO_CANmodule_init(). */
 		if(CANmodule->useCANrxFilters)
 		{
 			/* TODO Configure CAN module hardware filters */
 		}
-		else
-		{
-			/*no hardware filters*/
-			//CAN_FilterTypeDef FilterConfig;
-			struct can_filter  filter;
-			filter.id   = 0x0;
-			filter.mask = 0;
-			can_async_set_filter(CANmodule->CANBaseDescriptor, 0, CAN_FMT_STDID, &filter);
-		}
 	}
 	else
 	{
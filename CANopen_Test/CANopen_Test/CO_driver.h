@@ -56,6 +56,7 @@ extern "C" {
 
 /* Include processor header file */
 #include "driver_init.h"
+#include <peripheral_clk_config.h>
 
 
 #include <stddef.h>         /* for 'NULL' */
@@ -168,6 +169,11 @@ extern "C" {
  * that not all variables are allowed to be mapped to PDOs, so they may not need
  * to be protected. SDO server protects sections with access to OD variables.
  *
+ * Multi-byte OD entries are protected with sequence counters instead of long
+ * critical sections, see CO_OD_writeBegin() and CO_OD_readBegin(). Only
+ * incrementing the counter is done with CO_LOCK_OD(). CO_MEMORY_BARRIER()
+ * keeps data accesses between the counter accesses.
+ *
  * ####CAN receive thread.
  * It partially processes received CAN data and puts them into appropriate
  * objects. Objects are later processed. It does not need protection of
@@ -190,6 +196,11 @@ extern "C" {
 
 #define CO_LOCK_OD()            CO_LOCK_CAN_SEND()   /**< Lock critical section when accessing Object Dictionary */
 #define CO_UNLOCK_OD()          CO_UNLOCK_CAN_SEND() /**< Unlock critical section when accessing Object Dictionary */
+
+#define CO_LOCK_PDO()           CO_LOCK_CAN_SEND()   /**< Lock critical section in CO_TPDOtimers_process() or CO_TPDOsendNow() */
+#define CO_UNLOCK_PDO()         CO_UNLOCK_CAN_SEND() /**< Unlock critical section in CO_TPDOtimers_process() or CO_TPDOsendNow() */
+
+#define CO_MEMORY_BARRIER()     __DMB()              /**< Compiler and memory barrier around OD sequence counter */
 /** @} */
 
 
@@ -209,6 +220,66 @@ typedef unsigned char           domain_t;   /**< domain_t */
 typedef	struct can_async_descriptor CAN_Handler;
 /** @} */
 
+
+/**
+ * Linker section of the static arena with all CANopen objects, see CO_init().
+ * It is zero initialized by startup code and its size is shown in map file.
+ */
+#ifndef CO_ARENA_SECTION
+#define CO_ARENA_SECTION        __attribute__((section(".bss.CO_arena"), aligned(8)))
+#endif
+
+
+/**
+ * SDO buffer size of this target. Block upload of objects, which are not
+ * streamed, keeps the whole sub-block in the buffer until it is acknowledged,
+ * so full sub-block of 127 segments requires 889 bytes. Default size of 32
+ * bytes limits such transfer to 4 segments per sub-block.
+ */
+#ifndef CO_SDO_BUFFER_SIZE
+#define CO_SDO_BUFFER_SIZE      889
+#endif
+
+
+/**
+ * Free running 32 bit timer, DWT cycle counter, which is started by the
+ * application at reset. Difference of two values is valid across overflow.
+ */
+#ifndef CO_TIMER_TICKS
+#define CO_TIMER_TICKS()        (DWT->CYCCNT)
+#define CO_TIMER_TICKS_TO_US(ticks) ((ticks) / (CONF_CPU_FREQUENCY / 1000000U))
+#endif
+
+/**
+ * Time in microseconds from reset. Used for boot time measurement, see
+ * CO_init().
+ */
+#ifndef CO_TIMESTAMP_US
+#define CO_TIMESTAMP_US()       CO_TIMER_TICKS_TO_US(CO_TIMER_TICKS())
+#endif
+
+/**
+ * Atomic compare and exchange of one byte with exclusive access instructions.
+ *
+ * Byte is replaced only, if it still holds expected value. Exchange also
+ * fails, if exception occurs between both accesses, so caller reads the byte
+ * again and retries. Used for lock free exchange of RPDO receive buffers
+ * between CAN receive interrupt and PDO processing.
+ *
+ * @param p Pointer to the byte.
+ * @param expected Value read before.
+ * @param desired New value.
+ *
+ * @return True, if byte was replaced.
+ */
+static inline bool_t CO_atomicCAS8(volatile uint8_t *p, uint8_t expected, uint8_t desired){
+    if(__LDREXB(p) != expected){
+        __CLREX();
+        return false;
+    }
+    return (__STREXB(desired, p) == 0U) ? true : false;
+}
+
 /**
  * Return values of some CANopen functions. If function was executed
  * successfully it returns 0 otherwise it returns <0.
@@ -229,7 +300,8 @@ typedef enum{
 	CO_ERROR_PARAMETERS         = -12,  /**< Error in function parameters */
 	CO_ERROR_DATA_CORRUPT       = -13,  /**< Stored data are corrupt */
 	CO_ERROR_CRC                = -14,   /**< CRC does not match */
-	CO_ERROR_HAL		     	= -15	/**< HAL error */
+	CO_ERROR_HAL		     	= -15,	/**< HAL error */
+	CO_ERROR_TX_BUSY            = -16   /**< Data are being written, message was not sent */
 }CO_ReturnError_t;
 
 
@@ -351,6 +423,19 @@ CO_ReturnError_t CO_CANmodule_init(
 		uint16_t                CANbitRate);
 
 
+/**
+ * Prepare CAN module object for fast communication reset.
+ *
+ * CAN controller, its bit rate and hardware filters are kept running. Module
+ * leaves normal mode, pending transmit messages are dropped and all receive
+ * buffers are unbound, so received messages are ignored until CANopen objects
+ * call CO_CANrxBufferInit() again. Then CO_CANsetNormalMode() must be called.
+ *
+ * @param CANmodule CAN module object, initialized by CO_CANmodule_init().
+ */
+void CO_CANmodule_reset(CO_CANmodule_t *CANmodule);
+
+
 /**
  * Switch off CANmodule. Call at program exit.
  *
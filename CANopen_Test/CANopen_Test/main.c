@@ -35,6 +35,24 @@
 #include "task.h"
 #include "main.h"
 
+/* TARGET_IO is initialized on SERCOM3 by driver_init.c. Synchronous USART
+ * driver has no callbacks, so only its receive complete interrupt is used to
+ * wake the mainline from task_process(). */
+#define CONSOLE_SERCOM SERCOM3
+#define CONSOLE_RX_IRQn SERCOM3_2_IRQn
+
+/**
+ * \brief Console receive complete interrupt.
+ *
+ * Interrupt is disabled until received character is read in the main loop,
+ * because RXC flag is cleared only by reading the data.
+ */
+void SERCOM3_2_Handler(void)
+{
+	hri_sercomusart_clear_INTEN_RXC_bit(CONSOLE_SERCOM);
+	task_wakeUp();
+}
+
 /**
  * \brief display configuration menu.
  */
@@ -79,6 +97,7 @@ static void CAN_std_tx_callback(struct can_async_descriptor *const descr)
 static void CAN_0_rx_callback(struct can_async_descriptor *const descr)
 {
 	CAN_RxFifo1MsgPendingCallback();
+	task_wakeUp();
 	struct can_message msg;
 	uint8_t            data[64];
 	msg.data = data;
@@ -103,10 +122,19 @@ int main(void)
 	uint8_t tx_message_1[64];
 	uint8_t tx_message_2[8];
 
+	/* Boot time is measured from here */
+	task_startTimeBase();
+
 	/* Initializes MCU, drivers and middleware */
 	atmel_start_init();
+
+	/* CANopen boot-up is not delayed by the menu output */
+	task_coldStart();
 	display_menu();
 
+	/* Keystroke wakes the mainline from sleep */
+	NVIC_EnableIRQ(CONSOLE_RX_IRQn);
+
 	/* Initialize the data to be used later */
 	for (uint8_t i = 0; i < 64; i++) {
 		tx_message_0[i] = i;
@@ -119,9 +147,18 @@ int main(void)
 	for (uint8_t k = 0; k < 8; k++) {
 		tx_message_2[k] = k;
 	}
-	task_coldStart();
 
 	while (1) {
+		/* Interrupt is triggered immediately, if character is not read yet */
+		hri_sercomusart_set_INTEN_RXC_bit(CONSOLE_SERCOM);
+
+		/* CANopen processing, sleeps until the next deadline, CAN event or
+		 * keystroke */
+		task_process();
+
+		if (!usart_sync_is_rx_not_empty(&TARGET_IO)) {
+			continue;
+		}
 		scanf("%c", (char *)&key);
 
 		switch (key) {
@@ -257,10 +294,6 @@ int main(void)
 			can_async_enable(&CAN_0);
 			can_async_write(&CAN_0, &msg);
 			break;
-		case 'o':
-			task_oneMs();
-			break;
-
 		default:
 			break;
 		}
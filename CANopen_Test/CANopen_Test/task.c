@@ -3,7 +3,19 @@
  * \author      Andrii Shylenko
  *
  * \brief
- * Simple 1ms task implementation.
+ * Two priority task implementation.
+ *
+ * Real time context runs from SysTick interrupt. It processes SYNC, RPDO and
+ * TPDO objects and CAN transmission. SysTick is reprogrammed after each run to
+ * the earliest SYNC or TPDO deadline. Context also runs immediately after SYNC
+ * or asynchronous RPDO is received, so response TPDO is sent without waiting
+ * for the deadline, and after mainline processing, which changed PDO or SYNC
+ * parameters, mapped OD entries or NMT state.
+ *
+ * Mainline (background) context runs from main loop. It processes SDO, EMCY,
+ * NMT, heartbeat consumer and storage. It sleeps until the earliest deadline
+ * or until task_wakeUp() is called from CAN callbacks or from pFunctSignal
+ * of SDO server and Emergency objects.
  ******************************************************************************/
 
 /*-----------------------------------------------------------------------------
@@ -13,6 +25,7 @@
 
 //#include "can.h"
 #include "driver_init.h"
+#include <peripheral_clk_config.h>
 #include "CanOpen.h"
 
 /*EEPROM driver is not the part of the demonstration code*/
@@ -21,8 +34,33 @@
 /*-----------------------------------------------------------------------------
  * LOCAL (static) DEFINITIONS
  *----------------------------------------------------------------------------*/
+/* Core clock cycles per microsecond, used by DWT time base and SysTick. */
+#define TASK_CYCLES_PER_US      (CONF_CPU_FREQUENCY / 1000000U)
+
+/* Longest and shortest period of the real time context in microseconds.
+ * Longest period limits detection of Change of State of TPDOs, which are not
+ * notified about changed OD entries. It must fit into 24-bit SysTick. Shortest
+ * period limits load, while CAN transmit buffers are waiting. */
+#define TASK_RT_PERIOD_MAX_US   10000U
+#define TASK_RT_PERIOD_MIN_US   100U
+
+/* NVIC priority of the real time context (SysTick). CAN interrupt keeps
+ * higher priority, so received messages are never delayed. */
+#define TASK_RT_IRQ_PRIORITY    1U
+
+/* Upper bound for timerNext_ms passed to CO_process(). */
+#define TASK_TIMER_NEXT_MAX_MS  50U
+
+/* CANopen Node-ID and CAN bit rate in kbps */
+#define TASK_NODE_ID            2U
+#define TASK_BIT_RATE           250U
 
 static CO_NMT_reset_cmd_t reset;
+static volatile bool_t task_wakeupRequest;  /* set from interrupt, if mainline has new work */
+static uint32_t task_timestamp;             /* DWT cycle counter at previous mainline processing */
+static uint32_t task_rtTimestamp;           /* DWT cycle counter at previous real time processing */
+static volatile bool_t task_rtRequest;      /* real time context is triggered by RPDO reception */
+static uint32_t task_msRemainder_us;        /* part of time not yet passed to CO_process() */
 #ifdef CAN_USE_EEPROM
 static CO_EE_t                     CO_EEO;         /* Eeprom object */
 #endif
@@ -36,26 +74,155 @@ static CO_EE_t                     CO_EEO;         /* Eeprom object */
 /*-----------------------------------------------------------------------------
  * LOCAL FUNCTION PROTOTYPES
  *----------------------------------------------------------------------------*/
+static uint32_t task_timeDifference_us(uint32_t *timestamp);
+static void task_sleep(uint32_t time_us);
+static uint32_t task_realTime(void);
+static void task_realTimeTrigger(void);
+static void task_initCallbacks(void);
+static void task_resetCommunication(void);
 
 
 /*-----------------------------------------------------------------------------
  * LOCAL FUNCTIONS
  *----------------------------------------------------------------------------*/
+/* Time since previous call, measured by free running DWT cycle counter. */
+static uint32_t task_timeDifference_us(uint32_t *timestamp)
+{
+   uint32_t diff_us = (DWT->CYCCNT - *timestamp) / TASK_CYCLES_PER_US;
+
+   /* keep fraction of microsecond for the next call */
+   *timestamp += diff_us * TASK_CYCLES_PER_US;
+
+   return diff_us;
+}
+
+/* Sleep until time expires or any interrupt requests mainline processing.
+ * Real time context wakes the CPU at least once per TASK_RT_PERIOD_MAX_US. */
+static void task_sleep(uint32_t time_us)
+{
+   uint32_t start = DWT->CYCCNT;
+   uint32_t cycles = time_us * TASK_CYCLES_PER_US;
+
+   /* WFI wakes on pending interrupt even if masked, so a wakeup request
+    * between the check and WFI is not lost. */
+   __disable_irq();
+   while(!task_wakeupRequest && (DWT->CYCCNT - start) < cycles)
+   {
+      sleep(PM_SLEEPCFG_SLEEPMODE_IDLE_Val);
+
+      /* let pending interrupt run */
+      __enable_irq();
+      __disable_irq();
+   }
+   task_wakeupRequest = false;
+   __enable_irq();
+}
+
+/* Callbacks are cleared by initialization of CANopen objects. */
+static void task_initCallbacks(void)
+{
+   int16_t i;
+
+   /* wake up mainline on new SDO request or on new emergency */
+   CO_SDO_initCallback(CO->SDO[0], task_wakeUp);
+   CO_EM_initCallback(CO->em, task_wakeUp);
+
+   /* process SYNC, asynchronous RPDO and response TPDOs immediately */
+   CO_SYNC_initCallback(CO->SYNC, task_realTimeTrigger);
+   for(i = 0; i < CO_NO_RPDO; i++)
+   {
+      CO_RPDO_initCallback(CO->RPDO[i], task_realTimeTrigger);
+   }
+}
+
+/* NMT reset communication: CANopen objects are initialized again in place,
+ * CAN controller keeps running. Real time context is stopped meanwhile. */
+static void task_resetCommunication(void)
+{
+   if(CO_resetCommunication(TASK_NODE_ID) != CO_ERROR_NO)
+   {
+      _Error_Handler(0, 0);
+   }
+
+   task_initCallbacks();
+   CO_CANsetNormalMode(CO->CANmodule[0]);
+   reset = CO_RESET_NOT;
+
+   /* send boot-up message without waiting */
+   task_wakeupRequest = true;
+}
+
+/* Real time context, called from SysTick interrupt at the deadline returned
+ * from previous call or earlier, if triggered by task_realTimeTrigger().
+ * Returns time until the next call in microseconds. */
+static uint32_t task_realTime(void)
+{
+   uint32_t timeDifference_us = task_timeDifference_us(&task_rtTimestamp);
+   uint32_t timerNext_us = TASK_RT_PERIOD_MAX_US;
+
+   if(CO->CANmodule[0]->CANnormal)
+   {
+        bool_t syncWas;
+
+        /* Process Sync and read inputs */
+        syncWas = CO_process_SYNC_RPDO(CO, timeDifference_us, &timerNext_us);
+
+        /* Further I/O or nonblocking application code may go here. */
+
+        /* Write outputs */
+        CO_process_TPDO(CO, syncWas, timeDifference_us, &timerNext_us);
+
+        CO_CANpolling_Tx(CO->CANmodule[0]);
+
+        /* poll waiting transmit buffers */
+        if(CO->CANmodule[0]->CANtxCount > 0U)
+        {
+           timerNext_us = 0U;
+        }
+   }
+
+   if(timerNext_us < TASK_RT_PERIOD_MIN_US)
+   {
+      timerNext_us = TASK_RT_PERIOD_MIN_US;
+   }
+
+   return timerNext_us;
+}
+
+
+/* Called from CAN interrupt after SYNC or asynchronous RPDO is received and
+ * from mainline, if it changed data used by real time context. SysTick
+ * exception is set pending, so real time context runs as soon as CAN
+ * interrupt or mainline returns to it. */
+static void task_realTimeTrigger(void)
+{
+   task_rtRequest = true;
+   SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+}
 
 
 /*-----------------------------------------------------------------------------
  * GLOBAL FUNCTIONS - see descriptions in header file
  *----------------------------------------------------------------------------*/
+void task_startTimeBase(void)
+{
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CYCCNT = 0U;
+   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
 void task_coldStart(void)
 {
    //__HAL_DBGMCU_FREEZE_TIM6();
 
+   CO_BOOT_TIME(start);
 
 /*------------------------CAN Open stack--------------------------------*/
    CO_ReturnError_t err;
    /* CAN module address, NodeID, Bitrate */
    /* We do not use CAN registers directly, so address here is a pointer to the CAN_HandleTypeDef object. */
-   err = CO_init(&CAN_0, 2, 250);
+   err = CO_init(&CAN_0, TASK_NODE_ID, TASK_BIT_RATE);
 
    if(err != CO_ERROR_NO)
    {
@@ -63,42 +230,104 @@ void task_coldStart(void)
   	 _Error_Handler(0, 0);
    }
 
+   task_initCallbacks();
+
    /* start CAN */
    CO_CANsetNormalMode(CO->CANmodule[0]);
 
    reset = CO_RESET_NOT;
+
+   task_timestamp = DWT->CYCCNT;
+   task_rtTimestamp = task_timestamp;
+   task_msRemainder_us = 0U;
+   task_wakeupRequest = true;
+
+   /* start real time context */
+   NVIC_SetPriority(SysTick_IRQn, TASK_RT_IRQ_PRIORITY);
+   SysTick->LOAD = TASK_RT_PERIOD_MIN_US * TASK_CYCLES_PER_US - 1U;
+   SysTick->VAL = 0U;
+   SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+   /* send boot-up message now, heartbeat follows from task_process() */
+   reset = CO_process(CO, 0U, NULL, NULL);
+   CO_BOOT_TIME(bootUp);
+
+   /* non-critical initialization after boot-up */
+   CO_initDeferred();
+}
+
+
+void task_wakeUp(void)
+{
+   task_wakeupRequest = true;
 }
 
 
-void task_oneMs(void)
+void task_process(void)
 {
+    uint32_t timeDifference_us;
+    uint16_t timeDifference_ms;
+    uint16_t timerNext_ms = TASK_TIMER_NEXT_MAX_MS;
+    uint32_t timerNext_us;
+    bool_t PDOchanged = false;
+
+    timeDifference_us = task_timeDifference_us(&task_timestamp);
+
+    /* CO_process() works in milliseconds, keep the remainder for the next call */
+    task_msRemainder_us += timeDifference_us;
+    timeDifference_ms = (uint16_t)(task_msRemainder_us / 1000U);
+    task_msRemainder_us -= (uint32_t)timeDifference_ms * 1000U;
 
     /* CANopen process */
-    reset = CO_process(CO, 1, NULL);
+    reset = CO_process(CO, timeDifference_ms, &timerNext_ms, &PDOchanged);
+    if(reset == CO_RESET_COMM)
+    {
+        task_resetCommunication();
+        PDOchanged = true;
+    }
+
+    /* SDO changed mapped OD entries or TPDO timing or NMT state changed, so
+     * real time context verifies Change of State and takes the new deadline
+     * now. Otherwise it keeps its own deadline. */
+    if(PDOchanged)
+    {
+        task_realTimeTrigger();
+    }
+
+    timerNext_us = (uint32_t)timerNext_ms * 1000U;
+    timerNext_us = (timerNext_us > task_msRemainder_us) ? (timerNext_us - task_msRemainder_us) : 0U;
 
     /* Process EEPROM */
 #ifdef CAN_USE_EEPROM
           CO_EE_process(&CO_EEO);
 #endif
 
-   if(CO->CANmodule[0]->CANnormal)
-   {
-        bool_t syncWas;
+    /* Sleep until the earliest deadline or the next wakeup request */
+    task_sleep(timerNext_us);
+}
 
-        /* Process Sync and read inputs */
-        syncWas = CO_process_SYNC_RPDO(CO, 1000);
 
-        /* Further I/O or nonblocking application code may go here. */
+void SysTick_Handler(void)
+{
+   /* triggered run does not start at the beginning of the period */
+   bool_t triggered = task_rtRequest;
+   uint32_t timerNext_us;
 
-        /* Write outputs */
-        CO_process_TPDO(CO, syncWas, 1000);
+   task_rtRequest = false;
 
-        CO_CANpolling_Tx(CO->CANmodule[0]);
+   /* reading CTRL clears COUNTFLAG */
+   (void)SysTick->CTRL;
 
-        /* verify timer overflow */
-        if(0) {
-            CO_errorReport(CO->em, CO_EM_ISR_TIMER_OVERFLOW, CO_EMC_SOFTWARE_INTERNAL, 0U);
-        }
-    }
+   timerNext_us = task_realTime();
+
+   /* verify timer overflow: period expired again while processing */
+   if((SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) && !triggered)
+   {
+      CO_errorReport(CO->em, CO_EM_ISR_TIMER_OVERFLOW, CO_EMC_SOFTWARE_INTERNAL, 0U);
+   }
+
+   /* next run at the earliest deadline, writing VAL restarts the counter */
+   SysTick->LOAD = timerNext_us * TASK_CYCLES_PER_US - 1U;
+   SysTick->VAL = 0U;
 }
 
@@ -25,7 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  * \date        10.12.2018
  *
  * \brief
- * Simple 1ms task implementation.
+ * Two priority task implementation: real time context in SysTick interrupt
+ * and event driven mainline context in main loop.
  ******************************************************************************/
 #ifndef SCHEDULER_TASK_H_
 #define SCHEDULER_TASK_H_
@@ -48,7 +49,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /*-----------------------------------------------------------------------------
  * EXPORTED FUNCTIONS
  *----------------------------------------------------------------------------*/
+/* Start free running DWT time base. Called first in main(), so boot time
+ * phases in OD_bootTime are measured from reset. */
+void task_startTimeBase(void);
+
+/* Initialize CANopen, start real time context and send boot-up message.
+ * Initialization, which is not needed for boot-up, is done after it. */
 void task_coldStart(void);
-void task_oneMs(void);
+
+/* Request immediate processing of the mainline. May be called from interrupt,
+ * for example from CAN callback or from pFunctSignal of CANopen objects. */
+void task_wakeUp(void);
+
+/* Process mainline CANopen objects once and sleep until the earliest deadline
+ * or until task_wakeUp() is called. Must be called from the main loop. Real
+ * time objects (SYNC, PDO) are processed from SysTick interrupt. */
+void task_process(void);
 
 #endif /* SCHEDULER_TASK_H_ */
@@ -0,0 +1,778 @@
+#!/usr/bin/env python3
+"""
+CANopen Object Dictionary generator for CANopenNode.
+
+Reads device description in EDS (CiA 306) or XDD (CiA 311) format and writes
+CO_OD.h and CO_OD.c, which are used by the stack (see <CO_SDO.h>). Generated
+files have the same layout as the files from the CANopenNode Object
+Dictionary Editor, with the following optimizations:
+ - Members of sCO_OD_RAM, sCO_OD_EEPROM and sCO_OD_ROM are ordered by
+   alignment, so the compiler does not insert padding between them.
+ - Members of manufacturer and device profile records (index >= 0x2000) are
+   ordered the same way. Communication profile records are left as they are,
+   because the stack casts them to its own types (CO_RPDOCommPar_t, ...).
+ - Objects with AccessType=const are placed into const structure
+   sCO_OD_CONST, which is located in flash only.
+ - CO_OD_NoOfSubIndexes is emitted for the OD descriptor table, which is
+   built by CO_SDO_init().
+
+Optionally report with RAM and flash usage of each object is written. Sizes
+are calculated for 32-bit target (ARM EABI).
+
+Usage:
+    eds2co_od.py DEVICE.eds [-o OUTPUT_DIR] [-r REPORT_FILE]
+
+CANopenNode specific keys in EDS object or sub-object sections (XDD uses
+attributes with the same name, first letter lowercase):
+    StorageLocation = RAM | EEPROM | ROM   (default RAM)
+    TPDODetectCOS   = 0 | 1                (sets CO_ODA_TPDO_DETECT_COS)
+    StringLengthMin = n                    (length of VISIBLE/OCTET_STRING)
+Optional section [CANopenNode] may contain NoNMTMaster and NoTrace.
+
+C names are derived from ParameterName: non alphanumeric characters separate
+words, words are joined in camelCase. First letter of first word is lowered
+only if the second letter is lowercase, so "SDO server parameter" gives
+"SDOServerParameter" and "Device type" gives "deviceType".
+"""
+
+import argparse
+import configparser
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+
+# CiA 301 data types: code -> (C type, size, alignment, kind)
+DATA_TYPES = {
+    0x01: ("UNSIGNED8",      1, 1, "uint"),     # BOOLEAN
+    0x02: ("INTEGER8",       1, 1, "int"),
+    0x03: ("INTEGER16",      2, 2, "int"),
+    0x04: ("INTEGER32",      4, 4, "int"),
+    0x05: ("UNSIGNED8",      1, 1, "uint"),
+    0x06: ("UNSIGNED16",     2, 2, "uint"),
+    0x07: ("UNSIGNED32",     4, 4, "uint"),
+    0x08: ("REAL32",         4, 4, "real"),
+    0x09: ("VISIBLE_STRING", 1, 1, "vstr"),
+    0x0A: ("OCTET_STRING",   1, 1, "ostr"),
+    0x0F: ("DOMAIN",         1, 1, "domain"),
+    0x11: ("REAL64",         8, 8, "real"),
+    0x15: ("INTEGER64",      8, 8, "int"),
+    0x1B: ("UNSIGNED64",     8, 8, "uint"),
+}
+
+OBJ_VAR = 7
+OBJ_ARRAY = 8
+OBJ_RECORD = 9
+
+# Object dictionary attributes, see CO_SDO_OD_attributes_t
+ODA_MEM = {"ROM": 0x01, "RAM": 0x02, "EEPROM": 0x03, "CONST": 0x01}
+ODA_READABLE = 0x04
+ODA_WRITEABLE = 0x08
+ODA_RPDO_MAPABLE = 0x10
+ODA_TPDO_MAPABLE = 0x20
+ODA_TPDO_DETECT_COS = 0x40
+ODA_MB_VALUE = 0x80
+ODA_SIGNED = 0x100
+
+# Sizes of stack tables on 32-bit target
+SIZEOF_OD_ENTRY = 12          # CO_OD_entry_t
+SIZEOF_OD_ENTRY_RECORD = 8    # CO_OD_entryRecord_t
+SIZEOF_OD_EXTENSION = 20      # CO_OD_extension_t
+SIZEOF_OD_DESCRIPTOR = 8      # CO_OD_descriptor_t
+SIZEOF_OD_PAGE_TABLE = 257 * 2
+
+# Communication profile ranges, where consecutive objects with the same name
+# are grouped into array of records (for example OD_RPDOCommunicationParameter[4]).
+RECORD_ARRAY_RANGES = [(0x1200, 0x127F), (0x1280, 0x12FF), (0x1400, 0x15FF),
+                       (0x1600, 0x17FF), (0x1800, 0x19FF), (0x1A00, 0x1BFF)]
+
+STORAGES = ["RAM", "EEPROM", "ROM", "CONST"]
+
+
+class GeneratorError(Exception):
+    pass
+
+
+def c_name(text):
+    """Derive C identifier from ParameterName."""
+    words = re.sub(r"[^A-Za-z0-9_]", " ", text).split()
+    out = ""
+    for i, w in enumerate(words):
+        if i == 0:
+            if len(w) == 1 or w[1].islower():
+                w = w[0].lower() + w[1:]
+        else:
+            w = w[0].upper() + w[1:]
+        out += w
+    if not out or out[0].isdigit():
+        out = "_" + out
+    return out
+
+
+def parse_int(text, default=0):
+    """Parse integer value from EDS, $NODEID is added by the stack at runtime."""
+    if text is None:
+        return default
+    t = text.strip().upper().replace("$NODEID", "").lstrip("+").strip()
+    if t == "":
+        return default
+    return int(t, 0)
+
+
+class SubEntry:
+    def __init__(self, subIndex, name, dataType, access, default, pdo, cos, strLen):
+        if dataType not in DATA_TYPES:
+            raise GeneratorError("unsupported data type 0x%02X in '%s'" % (dataType, name))
+        self.subIndex = subIndex
+        self.name = name
+        self.cname = c_name(name)
+        self.dataType = dataType
+        self.access = access.lower()
+        self.default = default
+        self.pdo = pdo
+        self.cos = cos
+        self.ctype, self.size, self.align, self.kind = DATA_TYPES[dataType]
+        if self.kind in ("vstr", "ostr"):
+            self.length = strLen if strLen else max(len(self.string_bytes(0)), 1)
+            self.size = self.length
+        elif self.kind == "domain":
+            self.length = 0
+        else:
+            self.length = self.size
+
+    def string_bytes(self, length):
+        d = self.default or ""
+        if self.kind == "ostr":
+            data = [int(b, 16) for b in d.split()]
+            return data + [0] * (length - len(data))
+        return list(d) + [" "] * (length - len(d))
+
+    def attribute(self, storage):
+        attr = ODA_MEM[storage]
+        if self.access in ("ro", "const"):
+            attr |= ODA_READABLE
+        elif self.access == "wo":
+            attr |= ODA_WRITEABLE
+        else:
+            attr |= ODA_READABLE | ODA_WRITEABLE
+        if self.pdo:
+            attr |= ODA_RPDO_MAPABLE | ODA_TPDO_MAPABLE
+        if self.cos:
+            attr |= ODA_TPDO_DETECT_COS
+        if self.kind in ("int", "uint", "real") and self.size > 1:
+            attr |= ODA_MB_VALUE
+        if self.kind == "int":
+            attr |= ODA_SIGNED
+        return attr
+
+    def c_value(self):
+        """Initializer for this sub-entry."""
+        if self.kind in ("vstr", "ostr"):
+            if self.kind == "vstr":
+                return "{" + ", ".join("'%s'" % c.replace("'", "\\'") for c in self.string_bytes(self.length)) + "}"
+            return "{" + ", ".join("0x%02X" % b for b in self.string_bytes(self.length)) + "}"
+        if self.kind == "domain":
+            return "0"
+        if self.kind == "real":
+            return self.default.strip() if self.default and self.default.strip() else "0"
+        text = (self.default or "0").strip().upper().replace("$NODEID", "").lstrip("+").strip() or "0"
+        value = int(text, 0)
+        suffix = {4: "L", 8: "LL"}.get(self.size, "")
+        if text.startswith("0X"):
+            if value < 0:
+                value &= (1 << (self.size * 8)) - 1
+            return "0x%X%s" % (value, suffix)
+        return "%d%s" % (value, suffix)
+
+
+class Object:
+    def __init__(self, index, name, objectType, storage, subs):
+        self.index = index
+        self.name = name
+        self.cname = c_name(name)
+        self.objectType = objectType
+        self.storage = storage.upper()
+        self.subs = subs
+        if self.storage not in ODA_MEM:
+            raise GeneratorError("unknown StorageLocation '%s' in %04X" % (storage, index))
+        if objectType == OBJ_VAR:
+            if len(subs) != 1:
+                raise GeneratorError("VAR %04X must have one entry" % index)
+        elif len(subs) < 2:
+            raise GeneratorError("%04X must have sub-index 0 and at least one sub-entry" % index)
+        if all(s.access == "const" for s in subs):
+            self.storage = "CONST"
+
+    @property
+    def maxSubIndex(self):
+        return 0 if self.objectType == OBJ_VAR else len(self.subs) - 1
+
+
+def load_eds(path):
+    cp = configparser.ConfigParser(interpolation=None, strict=False,
+                                   comment_prefixes=(";",), inline_comment_prefixes=None)
+    cp.optionxform = str
+    with open(path, encoding="latin-1") as f:
+        cp.read_file(f)
+
+    def sub_entry(sec, subIndex, objSec):
+        def get(key, default=None):
+            if key in sec:
+                return sec[key]
+            return objSec.get(key, default) if objSec is not None else default
+        return SubEntry(subIndex,
+                        sec.get("ParameterName", ""),
+                        parse_int(get("DataType"), 0x07),
+                        get("AccessType", "rw"),
+                        sec.get("DefaultValue"),
+                        parse_int(sec.get("PDOMapping"), 0) != 0,
+                        parse_int(get("TPDODetectCOS"), 0) != 0,
+                        parse_int(sec.get("StringLengthMin"), 0))
+
+    objects = []
+    for secName in cp.sections():
+        if not re.fullmatch(r"[0-9A-Fa-f]{4}", secName):
+            continue
+        sec = cp[secName]
+        index = int(secName, 16)
+        objectType = parse_int(sec.get("ObjectType"), OBJ_VAR)
+        storage = sec.get("StorageLocation", "RAM")
+        if objectType == OBJ_VAR:
+            subs = [sub_entry(sec, 0, None)]
+        else:
+            subs = []
+            n = 0
+            while cp.has_section("%ssub%X" % (secName, n)):
+                subs.append(sub_entry(cp["%ssub%X" % (secName, n)], n, sec))
+                n += 1
+        objects.append(Object(index, sec.get("ParameterName", secName), objectType, storage, subs))
+
+    info = {}
+    for secName in ("FileInfo", "DeviceInfo", "CANopenNode"):
+        if cp.has_section(secName):
+            info.update(cp[secName])
+    return objects, info
+
+
+def load_xdd(path):
+    def local(tag):
+        return tag.rsplit("}", 1)[-1]
+
+    def sub_entry(el, subIndex, parent):
+        def get(key, default=None):
+            v = el.get(key)
+            if v is None and parent is not None:
+                v = parent.get(key)
+            return v if v is not None else default
+        return SubEntry(subIndex,
+                        el.get("name", ""),
+                        int(get("dataType", "0007"), 16),
+                        get("accessType", "rw"),
+                        el.get("defaultValue"),
+                        get("PDOmapping", "no") != "no",
+                        parse_int(get("TPDODetectCOS"), 0) != 0,
+                        parse_int(el.get("stringLengthMin"), 0))
+
+    root = ET.parse(path).getroot()
+    objects = []
+    for el in root.iter():
+        if local(el.tag) != "CANopenObject":
+            continue
+        index = int(el.get("index"), 16)
+        objectType = int(el.get("objectType", "7"))
+        storage = el.get("storageLocation", "RAM")
+        if objectType == OBJ_VAR:
+            subs = [sub_entry(el, 0, None)]
+        else:
+            subs = [sub_entry(s, int(s.get("subIndex"), 16), el)
+                    for s in el if local(s.tag) == "CANopenSubObject"]
+            subs.sort(key=lambda s: s.subIndex)
+        objects.append(Object(index, el.get("name", "%04X" % index), objectType, storage, subs))
+
+    info = {"FileName": os.path.basename(path)}
+    return objects, info
+
+
+def struct_layout(members):
+    """Return (size, alignment, padding) of C struct with (size, align) members."""
+    offset = padding = 0
+    maxAlign = 1
+    for size, align in members:
+        pad = (-offset) % align
+        padding += pad
+        offset += pad + size
+        maxAlign = max(maxAlign, align)
+    pad = (-offset) % maxAlign
+    return offset + pad, maxAlign, padding + pad
+
+
+def sort_by_alignment(items, align):
+    """Stable sort, largest alignment first, so no padding is needed."""
+    return sorted(items, key=lambda it: -align(it))
+
+
+class Member:
+    """One member of storage structure: object, array of records or record."""
+
+    def __init__(self, objects):
+        self.objects = objects
+        first = objects[0]
+        self.first = first
+        self.storage = first.storage
+        self.cname = first.cname
+        self.grouped = len(objects) > 1 or any(lo <= first.index <= hi for lo, hi in RECORD_ARRAY_RANGES) \
+            and first.objectType == OBJ_RECORD
+        self.tag = "%04X[%d]" % (first.index, len(objects)) if self.grouped else "%04X" % first.index
+
+        if first.objectType == OBJ_RECORD:
+            self.typeName = "OD_%s_t" % first.cname
+            # communication profile records are casted to stack types, keep the order
+            fields = list(first.subs)
+            if first.index >= 0x2000:
+                fields = sort_by_alignment(fields, lambda s: s.align)
+            self.recordFields = fields
+            size, self.align, self.recordPadding = struct_layout(
+                [(s.size if s.kind != "domain" else 1, s.align) for s in fields])
+            self.size = size * len(objects)
+            size, _, _ = struct_layout(
+                [(s.size if s.kind != "domain" else 1, s.align) for s in first.subs])
+            self.indexOrderSize = size * len(objects)
+            self.ctype = self.typeName
+            self.decl = "%s[%d]" % (self.cname, len(objects)) if self.grouped else self.cname
+        else:
+            sub = first.subs[-1]
+            self.recordFields = None
+            self.recordPadding = 0
+            self.indexOrderSize = None
+            self.align = sub.align
+            self.ctype = sub.ctype
+            if first.objectType == OBJ_ARRAY:
+                n = len(first.subs) - 1
+                self.size = sub.size * n
+                self.decl = "%s[%d]" % (self.cname, n)
+            elif sub.kind in ("vstr", "ostr"):
+                self.size = sub.length
+                self.decl = "%s[%d]" % (self.cname, sub.length)
+            else:
+                self.size = sub.size
+                self.decl = self.cname
+
+    def record_value(self, obj):
+        subs = {s.subIndex: s for s in obj.subs}
+        return "{" + ", ".join(subs[f.subIndex].c_value() for f in self.recordFields) + "}"
+
+    def init_lines(self):
+        first = self.first
+        if first.objectType == OBJ_RECORD:
+            if not self.grouped:
+                return ["/*%04X*/ %s," % (first.index, self.record_value(first))]
+            lines = []
+            for i, obj in enumerate(self.objects):
+                value = self.record_value(obj)
+                opening = "{" if i == 0 else " "
+                closing = "}," if i == len(self.objects) - 1 else ","
+                lines.append("/*%04X*/%s%s%s" % (obj.index, opening, value, closing))
+            return lines
+        if first.objectType == OBJ_ARRAY:
+            return ["/*%04X*/ {%s}," % (first.index, ", ".join(s.c_value() for s in first.subs[1:]))]
+        return ["/*%04X*/ %s," % (first.index, first.subs[0].c_value())]
+
+
+def build_members(objects):
+    members = []
+    i = 0
+    while i < len(objects):
+        obj = objects[i]
+        group = [obj]
+        rng = [r for r in RECORD_ARRAY_RANGES if r[0] <= obj.index <= r[1]]
+        if obj.objectType == OBJ_RECORD and rng:
+            while (i + len(group) < len(objects)
+                   and objects[i + len(group)].index == obj.index + len(group)
+                   and objects[i + len(group)].cname == obj.cname
+                   and rng[0][0] <= objects[i + len(group)].index <= rng[0][1]):
+                nxt = objects[i + len(group)]
+                if [s.dataType for s in nxt.subs] != [s.dataType for s in obj.subs] \
+                        or nxt.storage != obj.storage:
+                    raise GeneratorError("%04X must have the same structure as %04X" % (nxt.index, obj.index))
+                group.append(nxt)
+        members.append(Member(group))
+        i += len(group)
+    return members
+
+
+def storage_var(storage):
+    return "CO_OD_%s" % storage
+
+
+def data_pointer(member, obj, objIdx, sub):
+    """C expression for address of the sub-entry."""
+    base = storage_var(member.storage) + "." + member.cname
+    if member.grouped:
+        base += "[%d]" % objIdx
+    if obj.objectType == OBJ_RECORD:
+        if sub.kind == "domain":
+            return "0"
+        base += "." + sub.cname
+        if sub.kind in ("vstr", "ostr"):
+            base += "[0]"
+        return "(void*)&" + base
+    if sub.kind == "domain":
+        return "0"
+    if obj.objectType == OBJ_ARRAY or sub.kind in ("vstr", "ostr"):
+        base += "[0]"
+    return "(void*)&" + base
+
+
+def generate(objects, info, srcName):
+    objects = sorted(objects, key=lambda o: o.index)
+    indexes = [o.index for o in objects]
+    if len(set(indexes)) != len(indexes):
+        raise GeneratorError("duplicate object index")
+    members = build_members(objects)
+
+    h = []
+    c = []
+
+    # ---------------- CO_OD.h ----------------
+    h.append(LICENSE_HEADER.format(file="CO_OD.h", src=srcName))
+    h.append(H_TYPES)
+    h.append(FILE_INFO.format(
+        FileName=info.get("FileName", srcName), FileVersion=info.get("FileVersion", "-"),
+        CreationTime=info.get("CreationTime", "-"), CreationDate=info.get("CreationDate", "-"),
+        CreatedBy=info.get("CreatedBy", "-"), VendorName=info.get("VendorName", "-"),
+        VendorNumber=info.get("VendorNumber", "0"), ProductName=info.get("ProductName", "-"),
+        ProductNumber=info.get("ProductNumber", "0")))
+
+    def present(lst):
+        return [i for i in lst if i in indexes]
+
+    def in_range(lo, hi):
+        return [i for i in indexes if lo <= i <= hi]
+
+    features = [
+        ("CO_NO_SYNC", 1 if 0x1005 in indexes else 0, present([0x1005, 0x1006, 0x1007, 0x2103, 0x2104])),
+        ("CO_NO_EMERGENCY", 1 if 0x1014 in indexes else 0, present([0x1014, 0x1015])),
+        ("CO_NO_SDO_SERVER", len(in_range(0x1200, 0x127F)), in_range(0x1200, 0x127F)),
+        ("CO_NO_SDO_CLIENT", len(in_range(0x1280, 0x12FF)), in_range(0x1280, 0x12FF)),
+        ("CO_NO_RPDO", len(in_range(0x1400, 0x15FF)), in_range(0x1400, 0x15FF) + in_range(0x1600, 0x17FF)),
+        ("CO_NO_TPDO", len(in_range(0x1800, 0x19FF)), in_range(0x1800, 0x19FF) + in_range(0x1A00, 0x1BFF)),
+        ("CO_NO_NMT_MASTER", parse_int(info.get("NoNMTMaster"), 0), []),
+        ("CO_NO_TRACE", parse_int(info.get("NoTrace"), 0), []),
+    ]
+    h.append(SECTION.format("FEATURES"))
+    for name, value, assoc in features:
+        comment = ("//Associated objects: " + ", ".join("%04X" % i for i in assoc)) if assoc else ""
+        h.append("   #define %-30s %-3d %s" % (name, value, comment))
+    h.append("\n")
+
+    noOfSubIndexes = sum(o.maxSubIndex + 1 for o in objects)
+    h.append(SECTION.format("OBJECT DICTIONARY"))
+    h.append("   #define %-30s %d" % ("CO_OD_NoOfElements", len(objects)))
+    h.append("   #define %-30s %d" % ("CO_OD_NoOfSubIndexes", noOfSubIndexes))
+    h.append("\n")
+
+    h.append(SECTION.format("TYPE DEFINITIONS FOR RECORDS"))
+    for m in members:
+        if m.recordFields is None:
+            continue
+        h.append("/*%-10s*/ typedef struct{" % m.tag)
+        for s in m.recordFields:
+            decl = s.cname if s.kind not in ("vstr", "ostr") else "%s[%d]" % (s.cname, s.length)
+            h.append("               %-14s %s;" % (s.ctype, decl))
+        h.append("               }              %s;\n" % m.typeName)
+    h.append("")
+
+    h.append(SECTION.format("STRUCTURES FOR VARIABLES IN DIFFERENT MEMORY LOCATIONS"))
+    h.append("#define  CO_OD_FIRST_LAST_WORD     0x55 //Any value from 0x01 to 0xFE. If changed, EEPROM will be reinitialized.\n")
+
+    sorted_members = {}
+    for storage in STORAGES:
+        ms = [m for m in members if m.storage == storage]
+        sorted_members[storage] = sort_by_alignment(ms, lambda m: m.align)
+        if storage == "CONST" and not ms:
+            continue
+        title = {"RAM": "RAM", "EEPROM": "EEPROM", "ROM": "ROM", "CONST": "constant (flash)"}[storage]
+        h.append(("/***** Structure for %s variables " % title).ljust(79, "*") + "/")
+        h.append("struct s%s{" % storage_var(storage))
+        h.append("               UNSIGNED32     FirstWord;\n")
+        for m in sorted_members[storage]:
+            h.append("/*%-10s*/ %-14s %s;" % (m.tag, m.ctype, m.decl))
+        h.append("\n               UNSIGNED32     LastWord;")
+        h.append("};\n")
+
+    h.append("\n/***** Declaration of Object Dictionary variables *****************************/")
+    for storage in STORAGES:
+        if storage == "CONST":
+            if sorted_members[storage]:
+                h.append("extern const struct s%s %s;\n" % (storage_var(storage), storage_var(storage)))
+        else:
+            h.append("extern struct s%s %s;\n" % (storage_var(storage), storage_var(storage)))
+
+    h.append("\n" + SECTION.format("ALIASES FOR OBJECT DICTIONARY VARIABLES"))
+    # ODE_ is sequence number of OD entry in CO_OD[], as returned from CO_OD_find().
+    # Grouped records have consecutive entries.
+    entryNo = {obj.index: i for i, obj in enumerate(objects)}
+    for m in members:
+        first = m.first
+        sub = first.subs[-1]
+        target = storage_var(m.storage) + "." + m.cname
+        if first.objectType == OBJ_RECORD:
+            if m.grouped:
+                h.append("/*%s, Data Type: %s, Array[%d] */" % (m.tag, m.typeName, len(m.objects)))
+            else:
+                h.append("/*%s, Data Type: %s */" % (m.tag, m.typeName))
+            h.append("      #define %-42s %s" % ("OD_" + m.cname, target))
+            h.append("      #define %-42s %d" % ("ODE_" + m.cname, entryNo[first.index]))
+        elif first.objectType == OBJ_ARRAY:
+            n = len(first.subs) - 1
+            h.append("/*%s, Data Type: %s, Array[%d] */" % (m.tag, sub.ctype, n))
+            h.append("      #define %-42s %s" % ("OD_" + m.cname, target))
+            h.append("      #define %-42s %d" % ("ODE_" + m.cname, entryNo[first.index]))
+            h.append("      #define %-42s %d" % ("ODL_%s_arrayLength" % m.cname, n))
+            names = [s.cname for s in first.subs[1:]]
+            if len(set(names)) == len(names):
+                for i, name in enumerate(names):
+                    h.append("      #define %-42s %d" % ("ODA_%s_%s" % (m.cname, name), i))
+        elif sub.kind in ("vstr", "ostr"):
+            h.append("/*%s, Data Type: %s, Array[%d] */" % (m.tag, sub.ctype, sub.length))
+            h.append("      #define %-42s %s" % ("OD_" + m.cname, target))
+            h.append("      #define %-42s %d" % ("ODE_" + m.cname, entryNo[first.index]))
+            h.append("      #define %-42s %d" % ("ODL_%s_stringLength" % m.cname, sub.length))
+        else:
+            h.append("/*%s, Data Type: %s */" % (m.tag, sub.ctype))
+            h.append("      #define %-42s %s" % ("OD_" + m.cname, target))
+            h.append("      #define %-42s %d" % ("ODE_" + m.cname, entryNo[first.index]))
+        h.append("")
+    h.append("\n#endif\n")
+
+    # ---------------- CO_OD.c ----------------
+    c.append(LICENSE_HEADER.format(file="CO_OD.c", src=srcName))
+    c.append('#include "CO_driver.h"\n#include "CO_OD.h"\n#include "CO_SDO.h"\n\n')
+    c.append(SECTION.format("DEFINITION AND INITIALIZATION OF OBJECT DICTIONARY VARIABLES"))
+    for storage in STORAGES:
+        ms = sorted_members[storage]
+        if storage == "CONST" and not ms:
+            continue
+        title = {"RAM": "RAM", "EEPROM": "EEPROM", "ROM": "ROM", "CONST": "constant"}[storage]
+        qualifier = "const " if storage == "CONST" else ""
+        c.append(("/***** Definition for %s variables " % title).ljust(79, "*") + "/")
+        c.append("%sstruct s%s %s = {" % (qualifier, storage_var(storage), storage_var(storage)))
+        c.append("           CO_OD_FIRST_LAST_WORD,\n")
+        for m in ms:
+            c.extend(m.init_lines())
+        c.append("\n           CO_OD_FIRST_LAST_WORD,")
+        c.append("};\n\n")
+
+    c.append(SECTION.format("STRUCTURES FOR RECORD TYPE OBJECTS"))
+    for m in members:
+        if m.recordFields is None:
+            continue
+        for objIdx, obj in enumerate(m.objects):
+            c.append("/*0x%04X*/ const CO_OD_entryRecord_t OD_record%04X[%d] = {" % (obj.index, obj.index, len(obj.subs)))
+            rows = []
+            for s in obj.subs:
+                rows.append("           {%s, 0x%02X, %2d}" % (data_pointer(m, obj, objIdx, s), s.attribute(m.storage), s.length))
+            c.append(",\n".join(rows) + "};")
+    c.append("\n")
+
+    c.append(SECTION.format("OBJECT DICTIONARY"))
+    c.append("const CO_OD_entry_t CO_OD[CO_OD_NoOfElements] = {")
+    member_of = {}
+    for m in members:
+        for objIdx, obj in enumerate(m.objects):
+            member_of[obj.index] = (m, objIdx)
+    for obj in objects:
+        m, objIdx = member_of[obj.index]
+        if obj.objectType == OBJ_RECORD:
+            c.append("{0x%04X, 0x%02X, 0x00,  0, (void*)&OD_record%04X}," % (obj.index, obj.maxSubIndex, obj.index))
+        else:
+            sub = obj.subs[-1]
+            c.append("{0x%04X, 0x%02X, 0x%02X, %2d, %s}," % (
+                obj.index, obj.maxSubIndex, sub.attribute(m.storage), sub.length, data_pointer(m, obj, objIdx, sub)))
+    c.append("};\n\n")
+
+    return "\n".join(h), "\n".join(c), members, sorted_members, noOfSubIndexes
+
+
+def report(members, sorted_members, objects, noOfSubIndexes):
+    """RAM and flash usage of each object on 32-bit target."""
+    lines = []
+    lines.append("Object dictionary memory report (32-bit target)\n")
+    lines.append("%-9s %-34s %-7s %6s %6s %9s %7s" % ("Index", "Name", "Storage", "Data", "Pad", "OD flash", "OD RAM"))
+    totalFlash = totalRam = 0
+    for m in members:
+        for obj in m.objects:
+            data = m.size // len(m.objects)
+            pad = m.recordPadding
+            odFlash = SIZEOF_OD_ENTRY + (SIZEOF_OD_ENTRY_RECORD * len(obj.subs) if obj.objectType == OBJ_RECORD else 0)
+            odRam = SIZEOF_OD_EXTENSION + SIZEOF_OD_DESCRIPTOR * (obj.maxSubIndex + 1)
+            lines.append("%-9s %-34s %-7s %6d %6d %9d %7d" % (
+                "%04X" % obj.index, obj.name[:34], m.storage, data, pad, odFlash, odRam))
+            totalFlash += odFlash
+            totalRam += odRam
+    lines.append("")
+
+    structRam = structFlash = 0
+    for storage in STORAGES:
+        ms = sorted_members[storage]
+        if not ms and storage == "CONST":
+            continue
+        items = [(4, 4)] + [(m.size, m.align) for m in ms] + [(4, 4)]
+        size, _, pad = struct_layout(items)
+        orig = sorted(ms, key=lambda m: m.first.index)
+        sizeOrig, _, _ = struct_layout([(4, 4)] + [(m.indexOrderSize or m.size, m.align) for m in orig] + [(4, 4)])
+        where = "flash" if storage == "CONST" else "RAM + flash init image"
+        lines.append("s%-14s %6d bytes, padding %d (%d bytes in index order), %s" % (
+            storage_var(storage), size, pad, sizeOrig, where))
+        if storage != "CONST":
+            structRam += size
+        structFlash += size
+    lines.append("")
+    lines.append("OD tables in flash (CO_OD, records): %d bytes" % totalFlash)
+    lines.append("OD tables in RAM (extensions, %d descriptors, page table): %d bytes" % (
+        noOfSubIndexes, totalRam + SIZEOF_OD_PAGE_TABLE))
+    lines.append("Total RAM:   %d bytes" % (structRam + totalRam + SIZEOF_OD_PAGE_TABLE))
+    lines.append("Total flash: %d bytes" % (structFlash + totalFlash))
+    return "\n".join(lines) + "\n"
+
+
+SECTION = """/*******************************************************************************
+   {0}
+*******************************************************************************/"""
+
+LICENSE_HEADER = """/*
+ * CANopen Object Dictionary.
+ *
+ * This file was automatically generated with eds2co_od.py from {src}.
+ * DON'T EDIT THIS FILE MANUALLY !!!!
+ * For more information on CANopen Object Dictionary see <CO_SDO.h>.
+ *
+ * @file        {file}
+ * @author      Janez Paternoster
+ * @copyright   2010 - 2016 Janez Paternoster
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * CANopenNode is free and open source software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Following clarification and special exception to the GNU General Public
+ * License is included to the distribution terms of CANopenNode:
+ *
+ * Linking this library statically or dynamically with other modules is
+ * making a combined work based on this library. Thus, the terms and
+ * conditions of the GNU General Public License cover the whole combination.
+ *
+ * As a special exception, the copyright holders of this library give
+ * you permission to link this library with independent modules to
+ * produce an executable, regardless of the license terms of these
+ * independent modules, and to copy and distribute the resulting
+ * executable under terms of your choice, provided that you also meet,
+ * for each linked independent module, the terms and conditions of the
+ * license of that module. An independent module is a module which is
+ * not derived from or based on this library. If you modify this
+ * library, you may extend this exception to your version of the
+ * library, but you are not obliged to do so. If you do not wish
+ * to do so, delete this exception statement from your version.
+ */
+"""
+
+H_TYPES = """
+#ifndef CO_OD_H
+#define CO_OD_H
+
+#include "stdint.h"
+
+/*******************************************************************************
+   CANopen DATA DYPES
+*******************************************************************************/
+   typedef unsigned char  bool_t;     /**< bool_t */
+   typedef float          float32_t;  /**< float32_t */
+   typedef long double    float64_t;  /**< float64_t */
+   typedef char           char_t;     /**< char_t */
+   typedef unsigned char  oChar_t;    /**< oChar_t */
+   typedef unsigned char  domain_t;   /**< domain_t */
+
+   typedef uint8_t      UNSIGNED8;
+   typedef uint16_t     UNSIGNED16;
+   typedef uint32_t     UNSIGNED32;
+   typedef uint64_t     UNSIGNED64;
+   typedef int8_t       INTEGER8;
+   typedef int16_t      INTEGER16;
+   typedef int32_t      INTEGER32;
+   typedef int64_t      INTEGER64;
+   typedef float32_t    REAL32;
+   typedef float64_t    REAL64;
+   typedef char_t       VISIBLE_STRING;
+   typedef oChar_t      OCTET_STRING;
+   typedef domain_t     DOMAIN;
+"""
+
+FILE_INFO = """
+/*******************************************************************************
+   FILE INFO:
+      FileName:     {FileName}
+      FileVersion:  {FileVersion}
+      CreationTime: {CreationTime}
+      CreationDate: {CreationDate}
+      CreatedBy:    {CreatedBy}
+*******************************************************************************/
+
+
+/*******************************************************************************
+   DEVICE INFO:
+      VendorName:     {VendorName}
+      VendorNumber:   {VendorNumber}
+      ProductName:    {ProductName}
+      ProductNumber:  {ProductNumber}
+*******************************************************************************/
+
+"""
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Generate CANopenNode CO_OD.c/h from EDS or XDD file.")
+    ap.add_argument("input", help="EDS or XDD file")
+    ap.add_argument("-o", "--output", default=".", help="output directory for CO_OD.c and CO_OD.h")
+    ap.add_argument("-r", "--report", help="write RAM/flash report to this file ('-' for stdout)")
+    args = ap.parse_args()
+
+    try:
+        if args.input.lower().endswith((".xdd", ".xdc", ".xml")):
+            objects, info = load_xdd(args.input)
+        else:
+            objects, info = load_eds(args.input)
+        srcName = os.path.basename(args.input)
+        hText, cText, members, sorted_members, noOfSubIndexes = generate(objects, info, srcName)
+    except (GeneratorError, ValueError, KeyError, configparser.Error, ET.ParseError) as e:
+        sys.exit("eds2co_od: %s: %s" % (args.input, e))
+
+    with open(os.path.join(args.output, "CO_OD.h"), "w") as f:
+        f.write(hText)
+    with open(os.path.join(args.output, "CO_OD.c"), "w") as f:
+        f.write(cText)
+
+    if args.report:
+        text = report(members, sorted_members, objects, noOfSubIndexes)
+        if args.report == "-":
+            sys.stdout.write(text)
+        else:
+            with open(args.report, "w") as f:
+                f.write(text)
+
+
+if __name__ == "__main__":
+    main()